@@ -0,0 +1,92 @@
+#include "BarrettReducer.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+BarrettReducer::BarrettReducer(const BigInt& modulus) : m(modulus), n(modulus.data.size()){
+    if (m.neg || m.data.empty())
+        throw std::invalid_argument("Barrett modulus must be positive");
+    mu = BigInt::reciprocal(m, 2*n); // n+1 limbs, n+2 when m is a power of B
+}
+
+const BigInt& BarrettReducer::modulus() const {return m;}
+
+size_t BarrettReducer::scratch_size() const {
+    // q1*mu, q3*m and the remainder
+    return (2*n + 3) + (2*n + 2) + (n + 1);
+}
+
+void BarrettReducer::mullo(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn, size_t k){
+    // r = a*b mod B^k: rows are cut at k limbs and their carries out dropped
+    std::fill(r, r+k, 0);
+    for (size_t j=0; (j<bn) && (j<k); ++j){
+        limb_t c = BigInt::addmul_1(r+j, a, std::min(an, k-j), b[j]);
+        if (j+an < k) r[j+an] = c; // not reached by the rows above yet
+    }
+}
+
+void BarrettReducer::reduce_in_place(BigInt& x, limb_t* scratch) const {
+    size_t xn = x.data.size();
+    const limb_t* xd = x.data.data();
+    const limb_t* md = m.data.data();
+    if (xn > 2*n){ // out of range for one step
+        x %= m;
+    } else if (BigInt::cmp(xd, xn, md, n) >= 0){
+        // q3 = floor(floor(x / B^(n-1)) * mu / B^(n+1)) is q or falls short of it by at most 2
+        const limb_t* q1 = xd + (n-1);
+        size_t q1n = xn - (n-1), mun = mu.data.size();
+        limb_t* t = scratch;
+        if (q1n >= mun)
+            BigInt::mul(t, q1, q1n, mu.data.data(), mun);
+        else
+            BigInt::mul(t, mu.data.data(), mun, q1, q1n);
+        limb_t* q3 = t + (n+1);
+        size_t q3n = q1n + mun - (n+1);
+        while (q3n && (q3[q3n-1] == 0)) --q3n;
+
+        // r = x - q3*m mod B^(n+1), only the low n+1 limbs of both are needed
+        limb_t* p = t + (2*n + 3);
+        limb_t* r = p + (2*n + 2);
+        size_t pn = 0;
+        if (q3n < 2*BigInt::karatsuba_threshold){
+            mullo(p, md, n, q3, q3n, n+1);
+            pn = n+1;
+        } else {
+            if (q3n >= n)
+                BigInt::mul(p, q3, q3n, md, n);
+            else
+                BigInt::mul(p, md, n, q3, q3n);
+            pn = std::min(q3n + n, n+1);
+        }
+        std::fill(std::copy(p, p+pn, r), r+(n+1), 0);
+        limb_t* r1 = p; // x mod B^(n+1), zero padded
+        std::fill(std::copy(xd, xd+std::min(xn, n+1), r1), r1+(n+1), 0);
+        BigInt::sub(r, r1, n+1, r, n+1); // a borrow out is the wrap around B^(n+1)
+        while (BigInt::cmp(r, n+1, md, n) >= 0)
+            BigInt::sub(r, r, n+1, md, n);
+        size_t rn = n+1;
+        while (rn && (r[rn-1] == 0)) --rn;
+        x.data.assign(r, r+rn);
+    }
+    if (x.neg){
+        x.neg = false;
+        if (!x.data.empty()){ // m - |x|
+            size_t k = x.data.size();
+            x.data.resize(n, 0);
+            BigInt::sub(x.data.data(), md, n, x.data.data(), k);
+            while (x.data.back() == 0) x.data.pop_back();
+        }
+    }
+}
+
+BigInt BarrettReducer::reduce(const BigInt& x) const {
+    BigInt::scratch_vector scratch(scratch_size(), BigInt::scratch_resource());
+    BigInt res = x;
+    reduce_in_place(res, scratch.data());
+    return res;
+}
+
+void BarrettReducer::reduce(std::vector<BigInt>& values) const {
+    BigInt::scratch_vector scratch(scratch_size(), BigInt::scratch_resource());
+    for (BigInt& x : values)
+        reduce_in_place(x, scratch.data());
+}
@@ -0,0 +1,26 @@
+#ifndef BarrettReducer_HPP
+#define BarrettReducer_HPP
+
+#include <vector>
+#include "BigInt.hpp"
+
+// repeated reduction by one positive modulus m of n limbs through mu = floor(B^(2n) / m):
+// values below B^(2n) take two multiplications and no division, results are in [0, m)
+class BarrettReducer{
+    typedef BigInt::limb_t limb_t;
+    BigInt m;
+    BigInt mu;
+    size_t n; // limbs of m
+
+    static void mullo(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn, size_t k);
+    size_t scratch_size() const;
+    void reduce_in_place(BigInt& x, limb_t* scratch) const;
+public:
+    explicit BarrettReducer(const BigInt& modulus);
+
+    const BigInt& modulus() const;
+    BigInt reduce(const BigInt& x) const;
+    void reduce(std::vector<BigInt>& values) const; // every value in place, one scratch for all
+};
+
+#endif // BarrettReducer_HPP
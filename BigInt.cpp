@@ -3,6 +3,29 @@
 #include <cctype>
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
+
+// add-with-carry intrinsics for the 64-bit add and sub loops on x86-64
+#if (BIGINT_LIMB_BITS == 64) && (defined(__x86_64__) || defined(_M_X64))
+#  include <immintrin.h>
+#  define BIGINT_ADDCARRY
+#endif
+
+size_t BigInt::radix_threshold = (limb_bits == 64) ? 20 : 40;
+
+BigInt::MemoryScope::MemoryScope(std::pmr::memory_resource* res)
+: prev(small_vector_resource()) {
+    small_vector_resource() = res;
+}
+BigInt::MemoryScope::~MemoryScope(){
+    small_vector_resource() = prev;
+}
+std::pmr::memory_resource* BigInt::scratch_resource(){
+    // freed scratch blocks are kept for the next kernel call on the same thread,
+    // so the hot loops neither hit malloc nor contend with other threads
+    static thread_local std::pmr::unsynchronized_pool_resource pool;
+    return &pool;
+}
 
 int8_t BigInt::chtoi(const char& ch) const {
     if (ch <= '9')      return (ch - '0');
@@ -16,6 +39,172 @@ char BigInt::itoch(const uint8_t i) const {
     throw std::invalid_argument("invalid int");
 }
 
+BigInt::limb_t BigInt::add(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    size_t i = 0;
+#ifdef BIGINT_ADDCARRY
+    unsigned char c = 0;
+    unsigned long long s;
+    for (;i<bn; ++i){
+        c = _addcarry_u64(c, a[i], b[i], &s);
+        r[i] = s;
+    }
+#else
+    dlimb_t t = 0;
+    for (;i<bn; ++i){
+        t += static_cast<dlimb_t>(a[i]) + b[i];
+        r[i] = static_cast<limb_t>(t);
+        t >>= limb_bits;
+    }
+    limb_t c = static_cast<limb_t>(t);
+#endif
+    // the carry runs out within a limb or two, the rest is a copy
+    for (;c && (i<an); ++i){
+        r[i] = a[i] + 1;
+        c = (r[i] == 0);
+    }
+    if (r != a) std::copy(a+i, a+an, r+i);
+    return c;
+}
+BigInt::limb_t BigInt::sub(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    size_t i = 0;
+#ifdef BIGINT_ADDCARRY
+    unsigned char borrow = 0;
+    unsigned long long s;
+    for (;i<bn; ++i){
+        borrow = _subborrow_u64(borrow, a[i], b[i], &s);
+        r[i] = s;
+    }
+#else
+    dlimb_t t;
+    limb_t borrow = 0;
+    for (;i<bn; ++i){
+        t = static_cast<dlimb_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<limb_t>(t);
+        borrow = (t >> limb_bits) ? 1 : 0;
+    }
+#endif
+    for (;borrow && (i<an); ++i){
+        borrow = (a[i] == 0);
+        r[i] = a[i] - 1;
+    }
+    if (r != a) std::copy(a+i, a+an, r+i);
+    return borrow;
+}
+int BigInt::cmp(const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    // leading zero limbs are ignored
+    while (an && (a[an-1] == 0)) --an;
+    while (bn && (b[bn-1] == 0)) --bn;
+    if (an != bn) return ((an < bn) ? -1 : 1);
+    while (an){
+        --an;
+        if (a[an] != b[an]) return ((a[an] < b[an]) ? -1 : 1);
+    }
+    return 0;
+}
+BigInt::limb_t BigInt::mul_1(limb_t* r, const limb_t* a, size_t n, limb_t b){
+    dlimb_t t = 0;
+    for (size_t i=0; i<n; ++i){
+        t += static_cast<dlimb_t>(a[i]) * b;
+        r[i] = static_cast<limb_t>(t);
+        t >>= limb_bits;
+    }
+    return static_cast<limb_t>(t);
+}
+BigInt::limb_t BigInt::addmul_1(limb_t* r, const limb_t* a, size_t n, limb_t b){
+    dlimb_t t = 0;
+    for (size_t i=0; i<n; ++i){
+        t += static_cast<dlimb_t>(a[i]) * b + r[i]; // never overflows two limbs
+        r[i] = static_cast<limb_t>(t);
+        t >>= limb_bits;
+    }
+    return static_cast<limb_t>(t);
+}
+BigInt::limb_t BigInt::submul_1(limb_t* r, const limb_t* a, size_t n, limb_t b){
+    dlimb_t t, borrow = 0;
+    for (size_t i=0; i<n; ++i){
+        t = static_cast<dlimb_t>(a[i]) * b + borrow;
+        borrow = (t >> limb_bits) + (r[i] < static_cast<limb_t>(t));
+        r[i] -= static_cast<limb_t>(t);
+    }
+    return static_cast<limb_t>(borrow);
+}
+BigInt::limb_t BigInt::div_2by1(limb_t& r, limb_t u1, limb_t u0, limb_t d, limb_t v){
+    // (u1:u0) / d for a normalized d and u1 < d, v = floor((B^2-1)/d) - B (Moller-Granlund)
+    dlimb_t t = static_cast<dlimb_t>(v) * u1 + ((static_cast<dlimb_t>(u1) << limb_bits) | u0);
+    limb_t q = static_cast<limb_t>(t >> limb_bits) + 1;
+    r = u0 - q*d;
+    if (r > static_cast<limb_t>(t)){
+        --q;
+        r += d;
+    }
+    if (r >= d){
+        ++q;
+        r -= d;
+    }
+    return q;
+}
+BigInt::limb_t BigInt::divrem_1(limb_t* q, const limb_t* a, size_t n, limb_t d){
+    // one reciprocal up front instead of a double-width division per limb;
+    // an unnormalized d is shifted up and the dividend with it, limb by limb;
+    // a null q only takes the remainder
+    if (n == 0) return 0;
+    unsigned s = 0;
+    while (!(d >> (limb_bits-1))){
+        d <<= 1;
+        ++s;
+    }
+    limb_t v = static_cast<limb_t>(~static_cast<dlimb_t>(0) / d);
+    limb_t r = 0;
+    if (s == 0){
+        while (n){
+            --n;
+            limb_t qn = div_2by1(r, r, a[n], d, v);
+            if (q) q[n] = qn;
+        }
+        return r;
+    }
+    r = a[n-1] >> (limb_bits - s);
+    while (--n){
+        limb_t qn = div_2by1(r, r, (a[n] << s) | (a[n-1] >> (limb_bits - s)), d, v);
+        if (q) q[n] = qn;
+    }
+    limb_t q0 = div_2by1(r, r, a[0] << s, d, v);
+    if (q) q[0] = q0;
+    return r >> s; // remainder
+}
+BigInt::limb_t BigInt::lshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt){
+    // from the top down, so r may overlap a from above
+    unsigned back = limb_bits - cnt;
+    limb_t out = a[n-1] >> back;
+    while (--n){
+        r[n] = (a[n] << cnt) | (a[n-1] >> back);
+    }
+    r[0] = a[0] << cnt;
+    return out;
+}
+BigInt::limb_t BigInt::rshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt){
+    // from the bottom up, so r may overlap a from below
+    unsigned back = limb_bits - cnt;
+    limb_t out = a[0] << back;
+    for (size_t i=0; i+1<n; ++i){
+        r[i] = (a[i] >> cnt) | (a[i+1] << back);
+    }
+    r[n-1] = a[n-1] >> cnt;
+    return out;
+}
+BigInt BigInt::from_limbs(const limb_t* p, size_t n){
+    while (n && (p[n-1] == 0)) --n;
+    BigInt res;
+    res.data.assign(p, p+n);
+    return res;
+}
+BigInt::limb_t BigInt::div_1(limb_t d){
+    limb_t rem = divrem_1(data.data(), data.data(), data.size(), d);
+    while (data.size() && (data.back() == 0x0)) data.pop_back();
+    if (data.empty()) neg = false;
+    return rem;
+}
+
 
 BigInt::BigInt(){}
 BigInt::BigInt(const BigInt& other)
@@ -99,30 +288,29 @@ BigInt& BigInt::operator-=(const BigInt& other) & {
 
 BigInt& BigInt::operator*=(const BigInt& other) & {
     // selfAssignment supported
-    if (other.data.empty()){
-        neg = false;
-        data.clear();
-    } else if (!data.empty()){
-        BigInt res;
-        size_t i = 0, j = 0, size1 = data.size(), size2 = other.data.size();
-        res.data.resize(size1, 0);
-        uint64_t t, ovfl;
-        for(;j<size2; ++j){
-            t = 0;
-            ovfl = 0;
-            for(;i<size1; ++i){
-                t = static_cast<uint64_t>(data[i]) * other.data[j] + res.data[i+j] + ovfl;
-                res.data[i+j] = static_cast<uint32_t>(t);
-                ovfl = (t>>32);
-            }
-            res.data.push_back(static_cast<uint32_t>(ovfl));
-        }
-        if (res.data.back() == 0x0) res.data.pop_back();
-        neg ^= other.neg;
-        data = res.data;
+    if (&other == this){
+        *this = square();
+    } else {
+        mul_into(*this, *this, other, execution);
     }
     return *this;
 }
+void BigInt::mul_into(BigInt& res, const BigInt& int1, const BigInt& int2, Execution ex){
+    // res may be int1 or int2: the limbs go to a fresh buffer first
+    BIGINT_STATS_SCOPE(mul, std::max(int1.data.size(), int2.data.size()));
+    if (int1.data.empty() || int2.data.empty()){
+        res.neg = false;
+        res.data.clear();
+        return;
+    }
+    const limb_vector& a = ((int1.data.size() >= int2.data.size()) ? int1.data : int2.data);
+    const limb_vector& b = ((&a == &int1.data) ? int2.data : int1.data);
+    limb_vector r(a.size() + b.size());
+    mul_on(((ex == Execution::parallel) ? thread_pool() : nullptr), r.data(), a.data(), a.size(), b.data(), b.size());
+    if (r.back() == 0x0) r.pop_back();
+    res.neg = (int1.neg != int2.neg);
+    res.data = std::move(r);
+}
 BigInt& BigInt::operator/=(const BigInt& other) & {
     BigInt tmp;
     return (this->div(other, tmp));
@@ -130,63 +318,41 @@ BigInt& BigInt::operator/=(const BigInt& other) & {
 BigInt& BigInt::operator%=(const BigInt& other) & {
     BigInt remain;
     this->div(other, remain);
-    *this = remain;
+    *this = std::move(remain);
     return *this;
 }
 
 BigInt& BigInt::operator>>=(uint64_t shift) & {
     if (!data.empty() && (shift != 0)){
-        uint64_t t = shift % 32;
-        size_t i = 0, j = shift / 32;
-        if (t != 0){
-            uint64_t t1 = 32-t;
-            while (j+1<data.size()){
-                data[i] = (data[j] >> t);
-                data[i] |= (data[j+1] << t1);
-                ++i;
-                ++j;
-            }
+        unsigned t = shift % limb_bits;
+        size_t j = shift / limb_bits;
+        if (j >= data.size()){
+            data.clear();
         } else {
-            while (j+1<data.size()){
-                data[i] = data[j];
-                ++i;
-                ++j;
-            }
+            size_t n = data.size() - j;
+            if (t != 0)
+                rshift(data.data(), data.data()+j, n, t);
+            else
+                std::copy(data.begin()+j, data.end(), data.begin());
+            data.resize(n);
+            if (data.back() == 0) data.pop_back();
         }
-        data[i] = (data.back() >> t);
-        if (data[i]) data.resize(i+1);
-        else data.resize(i);
         if (data.empty()) neg = false;
     }
     return *this;
 }
 BigInt& BigInt::operator<<=(uint64_t shift) & {
     if (!data.empty() && (shift != 0)){
-        // data can be equal to {0} and shift == 1 (when calling from this->div()),
-        // then result must be equal to {0} exactly
-        int t = shift % 32;
-        size_t i = data.size(), j = data.size() + ((shift-1) / 32);
-        data.resize(j+1, 0);
+        unsigned t = shift % limb_bits;
+        size_t j = shift / limb_bits, n = data.size();
+        data.resize(n+j+1, 0);
         if (t != 0){
-            int t1 = 32-t;
-            while(i){
-                --i;
-                data[j] |= (data[i] >> t1);
-                --j;
-                data[j] = (data[i] << t);
-            }
-            if (data.back() == 0) data.pop_back();
+            data[n+j] = lshift(data.data()+j, data.data(), n, t);
         } else {
-            while(i){
-                --i;
-                --j;
-                data[j] = data[i];
-            }
-        }
-        while(j){
-            --j;
-            data[j] = 0;
+            std::copy_backward(data.begin(), data.begin()+n, data.begin()+n+j);
         }
+        std::fill(data.begin(), data.begin()+j, 0);
+        if (data.back() == 0) data.pop_back();
     }
     return *this;
 }
@@ -199,7 +365,7 @@ BigInt& BigInt::operator++() & {
         } else {
             size_t i = 1;
             while (true) {
-                data[i-1] = 0xFFFFFFFF;
+                data[i-1] = limb_max;
                 if (data[i] != 0x0){
                     --data[i];
                     break;
@@ -213,13 +379,13 @@ BigInt& BigInt::operator++() & {
         }
     } else if (data.empty()) {
         data.push_back(0x1);
-    } else if (data[0] != 0xFFFFFFFF){
+    } else if (data[0] != limb_max){
         ++data[0];
     } else {
         data[0] = 0x0;
         size_t i = 1;
         for (;i<data.size(); ++i){
-            if (data[i] != 0xFFFFFFFF){
+            if (data[i] != limb_max){
                 ++data[i];
                 return *this;
             }
@@ -231,12 +397,12 @@ BigInt& BigInt::operator++() & {
 }
 BigInt& BigInt::operator--() & {
     if (neg){
-        if (data[0] != 0xFFFFFFFF){
+        if (data[0] != limb_max){
             ++data[0];
         } else {
             data[0] = 0x0;
             for (size_t i=1;i<data.size(); ++i){
-                if (data[i] != 0xFFFFFFFF){
+                if (data[i] != limb_max){
                     ++data[i];
                     break;
                 }
@@ -253,7 +419,7 @@ BigInt& BigInt::operator--() & {
         } else {
             size_t i = 1;
             while (true) {
-                data[i-1] = 0xFFFFFFFF;
+                data[i-1] = limb_max;
                 if (data[i] != 0x0){
                     --data[i];
                     break;
@@ -277,43 +443,97 @@ BigInt BigInt::operator--(int) & {
 }
 
 BigInt BigInt::operator+() const {return BigInt(*this);} //
-BigInt BigInt::operator-() const {
+BigInt BigInt::operator-() const & {
     BigInt res(*this);
     if (data.size()) res.neg = !res.neg;
     return res;
 }
+BigInt BigInt::operator-() && {
+    BigInt res(std::move(*this));
+    if (res.data.size()) res.neg = !res.neg;
+    return res;
+}
 
+// plus_minus_op and div return a reference, so the results are built in named
+// locals (or the rvalue operand) which are then moved out, never copied
 BigInt operator+(const BigInt& int1, const BigInt& int2){
-    return BigInt(int1).plus_minus_op(int2, '+');
+    BigInt res(int1);
+    res.plus_minus_op(int2, '+');
+    return res;
+}
+BigInt operator+(BigInt&& int1, const BigInt& int2){
+    int1.plus_minus_op(int2, '+');
+    return std::move(int1);
+}
+BigInt operator+(const BigInt& int1, BigInt&& int2){
+    int2.plus_minus_op(int1, '+');
+    int2.def_base = int1.def_base; // the base comes from int1, as for every operator
+    return std::move(int2);
+}
+BigInt operator+(BigInt&& int1, BigInt&& int2){
+    int1.plus_minus_op(int2, '+');
+    return std::move(int1);
 }
 BigInt operator-(const BigInt& int1, const BigInt& int2){
-    return BigInt(int1).plus_minus_op(int2, '-');
+    BigInt res(int1);
+    res.plus_minus_op(int2, '-');
+    return res;
+}
+BigInt operator-(BigInt&& int1, const BigInt& int2){
+    int1.plus_minus_op(int2, '-');
+    return std::move(int1);
+}
+BigInt operator-(const BigInt& int1, BigInt&& int2){
+    // int1 - int2 == -(int2 - int1)
+    int2.plus_minus_op(int1, '-');
+    if (int2.data.size()) int2.neg = !int2.neg;
+    int2.def_base = int1.def_base;
+    return std::move(int2);
+}
+BigInt operator-(BigInt&& int1, BigInt&& int2){
+    int1.plus_minus_op(int2, '-');
+    return std::move(int1);
 }
 
 BigInt operator*(const BigInt& int1, const BigInt& int2){
-    BigInt res = int1;
-    res *= int2;
+    // the product needs a fresh buffer anyway, so no operand is copied
+    if (&int1 == &int2) return int1.square();
+    BigInt res;
+    res.def_base = int1.def_base;
+    BigInt::mul_into(res, int1, int2, BigInt::execution);
     return res;
 }
 BigInt operator/(const BigInt& int1, const BigInt& int2){
+    BigInt res;
+    res.def_base = int1.def_base;
+    BigInt::divmod(&res, nullptr, int1, int2);
+    return res;
+}
+BigInt operator/(BigInt&& int1, const BigInt& int2){
     BigInt tmp;
-    return BigInt(int1).div(int2, tmp);
+    int1.div(int2, tmp);
+    return std::move(int1);
 }
 BigInt operator%(const BigInt& int1, const BigInt& int2){
     BigInt remain;
-    BigInt(int1).div(int2, remain);
+    remain.def_base = int1.def_base;
+    BigInt::divmod(nullptr, &remain, int1, int2);
+    return remain;
+}
+BigInt operator%(BigInt&& int1, const BigInt& int2){
+    BigInt remain;
+    remain.def_base = int1.def_base;
+    int1.div(int2, remain); // a dividend smaller than the divisor just moves over
     return remain;
 }
 
-BigInt operator>>(const BigInt big_int, uint64_t shift){
-    BigInt res = big_int;
-    res >>= shift;
-    return res;
+BigInt operator>>(BigInt big_int, uint64_t shift){
+    big_int >>= shift;
+    return big_int;
 }
-BigInt operator<<(const BigInt big_int, uint64_t shift){
-    BigInt res = big_int;
-    res <<= shift;
-    return res;
+BigInt operator<<(BigInt big_int, uint64_t shift){
+    big_int <<= shift;
+    return big_int;
 }
 
 
@@ -358,9 +578,9 @@ void BigInt::from_string(std::string& str, uint8_t base) & {
     from_cstr(str.c_str(), base);
 }
 void BigInt::from_cstr(const char* p_str, uint8_t base) & {
+    BIGINT_STATS_SCOPE(from_string, this); // sized by the result
     if ((base == 1) || (base > 36))
         throw std::invalid_argument("invalid base (must be {0, 2, 3, ..., 36})");
-    data = {0};
     neg = false;
 
     while (isspace(*p_str)) {
@@ -394,142 +614,268 @@ void BigInt::from_cstr(const char* p_str, uint8_t base) & {
         base = def_base;
     }
 
-    std::vector<int8_t> dig;
-    while (true){
-        while (isblank(*p_str)) ++p_str;
-        if (base < 11){
-            if ((*p_str < '0') || ('0'+base <= *p_str)) break;
-        } else if (!(
-            (('0' <= *p_str) && (*p_str < '0'+10)) ||
-            (('A' <= *p_str) && (*p_str < 'A'+base-10)) ||
-            (('a' <= *p_str) && (*p_str < 'a'+base-10))
-        )) break;
-        dig.push_back(chtoi(*p_str));
-        ++p_str;
+    auto is_digit = [base](char ch){
+        if (base < 11)
+            return (('0' <= ch) && (ch < '0'+base));
+        return (
+            (('0' <= ch) && (ch < '0'+10)) ||
+            (('A' <= ch) && (ch < 'A'+base-10)) ||
+            (('a' <= ch) && (ch < 'a'+base-10))
+        );
+    };
+    size_t dig_count = 0;
+    for (const char* p = p_str; ; ++p){
+        while (isblank(*p)) ++p;
+        if (!is_digit(*p)) break;
+        ++dig_count;
     }
 
-    std::vector<uint32_t> spl{1}; //  base^k     2^32 
-    size_t k = dig.size()-1; // k -  ,    base
-    size_t i; // i -  spl  data, i <= spl.size() = data.size()
-    uint64_t t = 0, ovfl_data, ovfl_spl;
-    while (true){
-        ovfl_data = 0;
-        ovfl_spl = 0;
-        for (i=0; i<spl.size(); ++i){
-            t = static_cast<uint64_t>(spl[i]) * dig[k] + data[i] + ovfl_data;
-            ovfl_data = (t >> 32);
-            data[i] = static_cast<uint32_t>(t);
-
-            t = static_cast<uint64_t>(spl[i]) * base + ovfl_spl;
-            ovfl_spl = (t >> 32);
-            spl[i] = static_cast<uint32_t>(t);
-
-            if ((i == spl.size()-1) && (ovfl_data || ovfl_spl)){
-                spl.push_back(0);
-                data.push_back(0x0);
+    if ((base & (base-1)) == 0){ // 2, 4, 8, 16, 32: every digit is a group of bits
+        unsigned bits = 1;
+        while ((1u << bits) < base) ++bits;
+        data.assign((dig_count*bits + limb_bits-1) / limb_bits, 0);
+        for (size_t j=0; j<dig_count; ++j){
+            while (isblank(*p_str)) ++p_str;
+            limb_t dig = chtoi(*p_str);
+            ++p_str;
+            size_t pos = (dig_count-1-j) * bits; // lowest bit of the j-th digit
+            data[pos/limb_bits] |= dig << (pos%limb_bits);
+            if (pos%limb_bits + bits > limb_bits)
+                data[pos/limb_bits + 1] |= dig >> (limb_bits - pos%limb_bits);
+        }
+    } else {
+        // chunk = base^chunk_len is the largest power of base that fits one limb,
+        // chunk_len digits are gathered into one word, the first chunk takes the leftover digits
+        limb_t chunk = base;
+        size_t chunk_len = 1;
+        while (static_cast<dlimb_t>(chunk) * base <= limb_max){
+            chunk *= base;
+            ++chunk_len;
+        }
+        std::vector<limb_t> chunks((dig_count + chunk_len - 1) / chunk_len);
+        size_t k = (dig_count + chunk_len - 1) % chunk_len + 1; // digits in the current chunk
+        for (limb_t& c : chunks){
+            c = 0;
+            for (; k; --k){
+                while (isblank(*p_str)) ++p_str;
+                c = c * base + chtoi(*p_str);
+                ++p_str;
             }
+            k = chunk_len;
         }
-        if (k == 0) break;
-        --k;
+        std::vector<BigInt> pows{BigInt(chunk)};
+        data = std::move(from_chunks(chunks.data(), chunks.size(), pows).data);
     }
     while (data.size() && (data.back() == 0x0)) data.pop_back();
     if (data.empty()) neg = false;
 }
+BigInt BigInt::from_chunks(const limb_t* chunks, size_t n, std::vector<BigInt>& pows){
+    // chunks are the digits of the result in base pows[0], the most significant first
+    BigInt res;
+    if ((n < radix_threshold) || (n < 2)){
+        limb_t chunk = pows[0].data[0];
+        for (size_t j=0; j<n; ++j){
+            // res*chunk + chunks[j] < B^(size+1)
+            res.data.push_back(mul_1(res.data.data(), res.data.data(), res.data.size(), chunk));
+            add(res.data.data(), res.data.data(), res.data.size(), chunks+j, 1);
+            if (res.data.back() == 0x0) res.data.pop_back();
+        }
+        return res;
+    }
+    // product tree: the low part is the largest power of two chunks below n
+    size_t i = 0;
+    while ((static_cast<size_t>(2) << i) < n) ++i;
+    while (pows.size() <= i)
+        pows.push_back(pows.back() * pows.back());
+    size_t low = static_cast<size_t>(1) << i;
+    res = from_chunks(chunks, n-low, pows);
+    res *= pows[i];
+    res += from_chunks(chunks+(n-low), low, pows);
+    return res;
+}
 void BigInt::from_char(const char& ch) & {
     if (ch < '0') throw std::invalid_argument("invalid char " + ch);
     else if (ch == '0') data.clear();
-    else if (ch <= '9') data = {static_cast<uint32_t>(ch) - '0'};
+    else if (ch <= '9') data = {static_cast<limb_t>(ch) - '0'};
     else if (ch < 'A') throw std::invalid_argument("invalid char " + ch);
-    else if (ch <= 'Z') data = {static_cast<uint32_t>(ch) - 'A' + 10};
+    else if (ch <= 'Z') data = {static_cast<limb_t>(ch) - 'A' + 10};
     else if (ch < 'a') throw std::invalid_argument("invalid char " + ch);
-    else if (ch <= 'z') data = {static_cast<uint32_t>(ch) - 'a' + 10};
-    else throw std::invalid_argument("invalid char " + static_cast<uint32_t>(ch));
+    else if (ch <= 'z') data = {static_cast<limb_t>(ch) - 'a' + 10};
+    else throw std::invalid_argument("invalid char " + static_cast<limb_t>(ch));
     neg = false;
 }
 std::string BigInt::to_string(uint8_t base) const {
+    BIGINT_STATS_SCOPE(to_string, data.size());
     if (base == 0)
         base = def_base;
     else if ((base == 1) || (36 < base))
         throw std::invalid_argument("invalid base (must be {0, 2, 3, ..., 36})");
 
-
-    std::vector<uint8_t> dig_res{0};
-    std::vector<uint8_t> spl{1}; //  2^(32*k)      base
-    uint64_t t = 0; //  
-    size_t k = 0; // k -  ,    base
-    size_t i; // i -  spl  data, i <= spl.size() = dig_res.size()
-    uint64_t ovfl_res; // <= base
-    uint64_t ovfl_spl; // <= base
-    while (k < data.size()){
-        ovfl_res = 0;
-        ovfl_spl = 0;
-        for (i=0; i<spl.size(); ++i){
-            t = static_cast<uint64_t>(spl[i]) * data[k] + dig_res[i] + ovfl_res;
-            ovfl_res = t / base;
-            dig_res[i] = static_cast<uint8_t>(t % base);
-
-            t = (static_cast<uint64_t>(spl[i]) << 32) + ovfl_spl;
-            ovfl_spl = t / base;
-            spl[i] = static_cast<uint8_t>(t % base);
-
-            if ((i == spl.size()-1) && (ovfl_res || ovfl_spl)){
-                spl.push_back(0);
-                dig_res.push_back(0);
-            }
-        }
-        ++k;
-    }
-    while((dig_res.back() == 0) && (dig_res.size() > 1)) dig_res.pop_back();
-
     std::string res;
-    res.reserve(dig_res.size()+1);
+    if (data.empty())
+        return "0";
     if (neg)
         res.push_back('-');
-    i = dig_res.size();
-    while (i){
-        --i;
-        res.push_back(itoch(dig_res[i]));
+    size_t start = res.size();
+
+    if ((base & (base-1)) == 0){ // 2, 4, 8, 16, 32: every digit is a group of bits
+        unsigned bits = 1;
+        while ((1u << bits) < base) ++bits;
+        size_t len = (limb_bits*data.size() + bits - 1) / bits;
+        res.resize(start+len);
+        for (size_t j=0; j<len; ++j){
+            size_t pos = (len-1-j) * bits; // lowest bit of the j-th digit
+            limb_t dig = data[pos/limb_bits] >> (pos%limb_bits);
+            if ((pos%limb_bits + bits > limb_bits) && (pos/limb_bits + 1 < data.size()))
+                dig |= data[pos/limb_bits + 1] << (limb_bits - pos%limb_bits);
+            res[start+j] = itoch(dig & (base-1));
+        }
+    } else {
+        // chunk = base^chunk_len is the largest power of base that fits one limb
+        limb_t chunk = base;
+        size_t chunk_len = 1;
+        while (static_cast<dlimb_t>(chunk) * base <= limb_max){
+            chunk *= base;
+            ++chunk_len;
+        }
+        if (data.size() < radix_threshold){
+            // at most chunk_len+1 digits per limb
+            size_t len = (chunk_len+1) * data.size();
+            res.resize(start+len);
+            to_digits_word(&res[start], len, data, chunk, base);
+        } else {
+            // pows[i] = chunk^(2^i), until pows.back()^2 > |*this|
+            std::vector<BigInt> pows{BigInt(chunk)};
+            while (2*pows.back().data.size() - 1 <= data.size())
+                pows.push_back(pows.back() * pows.back());
+
+            size_t len = chunk_len << pows.size(); // |*this| has at most len digits
+            res.resize(start+len);
+            to_digits(&res[start], len, abs(), pows, pows.size(), base);
+        }
     }
+    size_t zeros = 0;
+    while (res[start+zeros] == '0') ++zeros;
+    res.erase(start, zeros);
     return res;
 }
 
+void BigInt::to_digits(char* p_str, size_t len, const BigInt& x, const std::vector<BigInt>& pows, size_t i, uint8_t base) const {
+    // writes exactly len = chunk_len * 2^i digits of x < pows[i-1]^2, padded with leading zeros
+    if ((i == 0) || (x.data.size() < radix_threshold)){
+        to_digits_word(p_str, len, x.data, pows[0].data[0], base);
+        return;
+    }
+    // x < pows[i-1]^2: both halves get len/2 digits
+    size_t half = len/2;
+    if (cmp(x.data.data(), x.data.size(), pows[i-1].data.data(), pows[i-1].data.size()) < 0){
+        std::fill(p_str, p_str+half, '0');
+        to_digits(p_str+half, half, x, pows, i-1, base);
+        return;
+    }
+    BigInt r;
+    BigInt q = divided(x, pows[i-1], r);
+    to_digits(p_str, half, q, pows, i-1, base);
+    to_digits(p_str+half, half, r, pows, i-1, base);
+}
+
+void BigInt::to_digits_word(char* p_str, size_t len, const limb_vector& x, limb_t chunk, uint8_t base) const {
+    // word at a time: every single-limb division by chunk = base^chunk_len gives chunk_len digits;
+    // writes exactly len digits of |x|, padded with leading zeros
+    limb_vector t = x;
+    size_t n = t.size();
+    while (len && n){
+        limb_t rem = divrem_1(t.data(), t.data(), n, chunk);
+        if (t[n-1] == 0) --n;
+        for (limb_t k=chunk; (k > 1) && len; k /= base){
+            p_str[--len] = itoch(rem % base);
+            rem /= base;
+        }
+    }
+    while (len) p_str[--len] = '0';
+}
+
 char* BigInt::to_cstr(char* p_str, uint8_t base) const {
     return std::strcpy(p_str, to_string(base).c_str());
 }
 
 BigInt& BigInt::plus_minus_op(const BigInt& other, const char& sign){
     // selfAssignment supported
-    int64_t k = ((neg == other.neg) ? 1 : -1);
-    if (sign == '-'){
-        k = -k;
-    } else if (sign != '+'){
+    if ((sign != '+') && (sign != '-'))
         throw std::invalid_argument("invalid sign in plus_minus_op (mast be '+' or '-')");
+    return add_limbs(other.data.data(), other.data.size(), (other.neg != (sign == '-')));
+}
+BigInt& BigInt::add_limbs(const limb_t* other, size_t size2, bool other_neg){
+    // other may be this->data itself: then the sizes match and nothing is resized under it
+    size_t size1 = data.size();
+    if (neg == other_neg){ // |this| + |other|
+        if (size1 < size2)
+            data.resize(size2, 0x0);
+        limb_t ovfl = add(data.data(), data.data(), data.size(), other, size2);
+        if (ovfl) data.push_back(ovfl);
+    } else if (cmp(data.data(), size1, other, size2) >= 0){ // |this| - |other|
+        sub(data.data(), data.data(), size1, other, size2);
+    } else { // |other| - |this|
+        data.resize(size2, 0x0);
+        sub(data.data(), other, size2, data.data(), size1);
+        neg = other_neg;
     }
-    int64_t temp;
-    uint32_t ovfl = 0;
-    size_t i = 0, size_ = other.data.size();
-
-    if (size_ > data.size())
-        data.resize(other.data.size(), 0x0);
-    for (;i<size_; ++i){
-        temp = data[i] + k*(other.data[i] + ovfl); // 0xffffffff00000000 <= temp <= 0x1ffffffff
-        ovfl = (temp >> 32)&0x1; // 0 or 1.
-        // Warning! negative rshift is implementation-defined until C++20
-        data[i] = static_cast<uint32_t>(temp); // temp % 2^32
-    }
-    if (ovfl){
-        if (k == 1){
-            data.push_back(0x1);
-        } else {
-            for (i=0; i<size_; ++i){
-                if (data[i] != 0){
-                    data[i] = (~data[i]) + 1;
-                    break;
-                }
-            }
-            for (;i<size_; ++i){
-                data[i] = ~data[i];
-            }
+    while (data.size() && (data.back() == 0x0)) data.pop_back();
+    if (data.empty()) neg = false;
+    return *this;
+}
+
+BigInt& BigInt::addmul(const BigInt& int1, const BigInt& int2) & {
+    return mul_acc(int1.data.data(), int1.data.size(), int2.data.data(), int2.data.size(), 0, (int1.neg != int2.neg));
+}
+BigInt& BigInt::submul(const BigInt& int1, const BigInt& int2) & {
+    return mul_acc(int1.data.data(), int1.data.size(), int2.data.data(), int2.data.size(), 0, (int1.neg == int2.neg));
+}
+BigInt& BigInt::add_shifted(const BigInt& other, uint64_t shift) & {
+    // other << shift is other * 2^(shift % limb_bits) placed shift / limb_bits limbs up
+    limb_t m = static_cast<limb_t>(1) << (shift % limb_bits);
+    return mul_acc(other.data.data(), other.data.size(), &m, 1, shift / limb_bits, other.neg);
+}
+BigInt& BigInt::sub_shifted(const BigInt& other, uint64_t shift) & {
+    limb_t m = static_cast<limb_t>(1) << (shift % limb_bits);
+    return mul_acc(other.data.data(), other.data.size(), &m, 1, shift / limb_bits, !other.neg);
+}
+BigInt& BigInt::mul_acc(const limb_t* a, size_t an, const limb_t* b, size_t bn, size_t off, bool p_neg){
+    // short products are accumulated row by row with addmul_1/submul_1 right in the limbs,
+    // long ones (or operands living in these limbs) go through one product buffer
+    if ((an == 0) || (bn == 0)) return *this;
+    if (an < bn){
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if ((bn >= karatsuba_threshold) || (a == data.data()) || (b == data.data())){
+        limb_vector t(off + an + bn, 0x0);
+        mul(t.data() + off, a, an, b, bn);
+        size_t tn = t.size();
+        while (t[tn-1] == 0x0) --tn;
+        return add_limbs(t.data(), tn, p_neg);
+    }
+    size_t n = data.size(), len = std::max(n, off + an + bn) + 1;
+    data.resize(len, 0x0);
+    limb_t* r = data.data() + off;
+    size_t rn = len - off;
+    if ((n == 0) || (neg == p_neg)){ // |this| + |a*b|, the extra top limb takes every carry
+        for (size_t j=0; j<bn; ++j){
+            limb_t c = addmul_1(r+j, a, an, b[j]);
+            if (c) add(r+j+an, r+j+an, rn-j-an, &c, 1);
+        }
+        neg = p_neg;
+    } else { // |this| - |a*b| modulo B^len, a borrow out of the top means the sign flips
+        limb_t borrow = 0;
+        for (size_t j=0; j<bn; ++j){
+            limb_t c = submul_1(r+j, a, an, b[j]);
+            if (c) borrow |= sub(r+j+an, r+j+an, rn-j-an, &c, 1);
+        }
+        if (borrow){
+            r = data.data();
+            for (size_t i=0; i<len; ++i) r[i] = ~r[i];
+            limb_t one = 1;
+            add(r, r, len, &one, 1);
             neg = !neg;
         }
     }
@@ -537,6 +883,83 @@ BigInt& BigInt::plus_minus_op(const BigInt& other, const char& sign){
     if (data.empty()) neg = false;
     return *this;
 }
+
+size_t BigInt::native_limbs(limb_t* p, uint64_t mag){
+    size_t n = 0;
+    while (mag){
+        p[n++] = static_cast<limb_t>(mag);
+        mag >>= limb_bits/2; // two half steps: shifting by the full width is undefined
+        mag >>= limb_bits/2;
+    }
+    return n;
+}
+BigInt& BigInt::add_native(uint64_t mag, bool mag_neg){
+    limb_t p[native_max_limbs];
+    return add_limbs(p, native_limbs(p, mag), mag_neg);
+}
+BigInt& BigInt::mul_native(uint64_t mag, bool mag_neg){
+    limb_t p[native_max_limbs];
+    size_t pn = native_limbs(p, mag), n = data.size();
+    if ((pn == 0) || (n == 0)){
+        data.clear();
+        neg = false;
+    } else if (pn == 1){
+        limb_t ovfl = mul_1(data.data(), data.data(), n, p[0]);
+        if (ovfl) data.push_back(ovfl);
+        neg = (neg != mag_neg);
+    } else {
+        limb_vector res(n + pn);
+        if (n >= pn)
+            mul(res.data(), data.data(), n, p, pn);
+        else
+            mul(res.data(), p, pn, data.data(), n);
+        while (res.back() == 0x0) res.pop_back();
+        data = std::move(res);
+        neg = (neg != mag_neg);
+    }
+    return *this;
+}
+uint64_t BigInt::div_native(uint64_t mag, bool mag_neg){
+    limb_t p[native_max_limbs];
+    size_t pn = native_limbs(p, mag);
+    if (pn == 0)
+        throw std::invalid_argument("division by zero");
+    uint64_t rem;
+    if (pn == 1){
+        rem = divrem_1(data.data(), data.data(), data.size(), p[0]);
+        while (data.size() && (data.back() == 0x0)) data.pop_back();
+    } else { // a 64-bit divisor over 32-bit limbs
+        BigInt r;
+        bool this_neg = neg;
+        neg = false;
+        div(BigInt(mag), r);
+        rem = 0;
+        for (size_t i=r.data.size(); i; --i){
+            rem <<= limb_bits/2;
+            rem <<= limb_bits/2;
+            rem |= r.data[i-1];
+        }
+        neg = this_neg;
+    }
+    neg = (!data.empty()) && (neg != mag_neg);
+    return rem;
+}
+uint64_t BigInt::mod_native(uint64_t mag) const {
+    limb_t p[native_max_limbs];
+    size_t pn = native_limbs(p, mag);
+    if (pn == 0)
+        throw std::invalid_argument("division by zero");
+    if (pn == 1)
+        return divrem_1(nullptr, data.data(), data.size(), p[0]);
+    return BigInt(*this).div_native(mag, false);
+}
+int BigInt::cmp_native(uint64_t mag, bool mag_neg) const {
+    limb_t p[native_max_limbs] = {};
+    size_t pn = native_limbs(p, mag);
+    if ((neg != mag_neg) && (pn || neg)) return (neg ? -1 : 1);
+    int res = cmp(data.data(), data.size(), p, pn);
+    return (neg ? -res : res);
+}
 BigInt& BigInt::div(const BigInt& other, BigInt& remain) { //
     // selfAssignment supported
     if (other.data.size() == 0){
@@ -553,90 +976,92 @@ BigInt& BigInt::div(const BigInt& other, BigInt& remain) { //
         *this = tmp;
         return *this;
     }
-    BigInt tmp(other, '+');
-    bool this_neg = this->neg;
-    remain.data = std::move(this->data);
-    remain.neg = false;
-
-    this->neg = false;
-    (this->data).clear();
-    if (remain < tmp){
-        remain.neg = this_neg;
-         // *this == 0
+    // &remain == &other is fine: other is not read after remain is written
+    if (cmp(data.data(), data.size(), other.data.data(), other.data.size()) < 0){
+        remain.data = std::move(this->data);
+        remain.neg = this->neg;
+        this->neg = false;
+        (this->data).clear(); // *this == 0
         return *this;
     }
-
-    uint64_t bit_size0 = tmp.bit_size();
-    uint64_t shift0 = (remain.bit_size() - bit_size0); // >= 0
-    uint64_t shift1 = 0;
-    tmp <<= shift0;
-    (this->data).push_back(0);
-    while (true){
-        if (remain >= tmp){ // remain.bit_size() == tmp.bit_size()
-            ++((this->data)[0])
-            remain -= tmp;
-            shift1 = (bit_size0 + shift0 - remain.bit_size()); // >= 1
-        } else {
-            shift1 = 1;
+    divmod(this, &remain, *this, other);
+    return *this;
+}
+void BigInt::divmod(BigInt* q, BigInt* r, const BigInt& a, const BigInt& b){
+    // q and r are written only once a and b have been read
+    BIGINT_STATS_SCOPE(div, a.data.size());
+    if (b.data.empty()){
+        throw std::invalid_argument("division by zero");
+    }
+    bool a_neg = a.neg, b_neg = b.neg;
+    size_t size1 = a.data.size(), size2 = b.data.size();
+    if (cmp(a.data.data(), size1, b.data.data(), size2) < 0){
+        if (r) *r = a;
+        if (q){
+            q->data.clear();
+            q->neg = false;
         }
-        if (shift0 < shift1)
-            break;
-        tmp >>= shift1;
-        shift0 -= shift1;
-        *this <<= shift1; // *this can be invalid, but it's ok
+        return;
     }
-    *this <<= shift0;
 
-    remain.neg = (this_neg && (!remain.data.empty()));
-    this->neg = (this_neg != other.neg); // data.size() > 0
-    return *this;
+    limb_vector qd(size1-size2+1), rd(size2);
+    divrem(qd.data(), rd.data(), a.data.data(), size1, b.data.data(), size2);
+    if (q){
+        while (qd.back() == 0x0) qd.pop_back(); // q > 0
+        q->data = std::move(qd);
+        q->neg = (a_neg != b_neg);
+    }
+    if (r){
+        while (rd.size() && (rd.back() == 0x0)) rd.pop_back();
+        r->data = std::move(rd);
+        r->neg = (a_neg && (!r->data.empty()));
+    }
 }
 BigInt divided(const BigInt& int1, const BigInt& int2, BigInt& remain){
-    return BigInt(int1).div(int2, remain);
+    BigInt res;
+    res.def_base = int1.def_base;
+    BigInt::divmod(&res, &remain, int1, int2);
+    return res;
+}
+BigInt multiplied(const BigInt& int1, const BigInt& int2, BigInt::Execution ex){
+    if (&int1 == &int2) return int1.square(ex);
+    BigInt res;
+    res.def_base = int1.def_base;
+    BigInt::mul_into(res, int1, int2, ex);
+    return res;
 }
 
 size_t BigInt::bit_size() const {
-    // super fast version
+    // binary search for the top bit of the last limb
     if (data.empty()) return 0;
-    size_t res = (data.size()-1)*sizeof(uint32_t);
-    uint32_t last = data.back();
-    uint32_t k;
-    if (last&0xffff0000){
-        if (last&0xff000000) {
-            res += 28;
-            k = 0xf0000000;
-        } else {
-            res += 20;
-            k = 0xfff00000;
-        }
-    } else {
-        if (last&0xffffff00) {
-            res += 12;
-            k = 0xfffff000;
-        } else {
-            res += 4;
-            k = 0xfffffff0;
-        }
-    }
-    size_t shift = 2;
-    while (shift){
-        if (last & k){
-            k <<= shift;
+    size_t res = (data.size()-1)*limb_bits + 1;
+    limb_t last = data.back();
+    for (unsigned shift = limb_bits/2; shift; shift >>= 1){
+        if (last >> shift){
+            last >>= shift;
             res += shift;
-        } else {
-            k >>= shift;
-            res -= shift;
         }
-        shift >>= 1;
     }
-    if (last & k) ++res;
     return res;
 }
 const BigInt BigInt::abs() const {return BigInt(*this, false);}
+BigInt BigInt::square() const {return square(execution);}
+BigInt BigInt::square(Execution ex) const {
+    BIGINT_STATS_SCOPE(sqr, data.size());
+    BigInt res;
+    res.def_base = def_base; // as for any product, so x*x prints like x*y
+    if (!data.empty()){
+        size_t n = data.size();
+        res.data.resize(2*n);
+        mul_on(((ex == Execution::parallel) ? thread_pool() : nullptr), res.data.data(), data.data(), n, data.data(), n);
+        if (res.data.back() == 0x0) res.data.pop_back();
+    }
+    return res;
+}
 bool BigInt::is_valid() const {
     if (data.empty() && neg){
         throw std::runtime_error("oops, something went worth: BigInt is not valid (*this == 0, but is negative)");
-    } else if (data.back() == 0){
+    } else if (!data.empty() && (data.back() == 0)){
         throw std::runtime_error("oops, something went worth: BigInt is not valid (this->data.back() == 0)");
     }
     return true;
@@ -1,11 +1,38 @@
 #ifndef BigInt_HPP
 #define BigInt_HPP
 
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory_resource>
+#include "SmallVector.hpp"
+
+// limb width: 64-bit limbs wherever the compiler has a 128-bit integer type
+// for the double-width intermediates, 32-bit limbs otherwise;
+// build with -DBIGINT_LIMB_BITS=32 to force the narrow ones
+#ifndef BIGINT_LIMB_BITS
+#  ifdef __SIZEOF_INT128__
+#    define BIGINT_LIMB_BITS 64
+#  else
+#    define BIGINT_LIMB_BITS 32
+#  endif
+#endif
+#if BIGINT_LIMB_BITS != 32 && BIGINT_LIMB_BITS != 64
+#  error "BIGINT_LIMB_BITS must be 32 or 64"
+#endif
+
+// build with -DBIGINT_STATS to gather the operation statistics of BigInt::stats();
+// without it the hooks below expand to nothing
+#ifdef BIGINT_STATS
+#  define BIGINT_STATS_SCOPE(op, size) BigInt::StatsScope bigint_stats_scope(BigInt::Operation::op, size)
+#else
+#  define BIGINT_STATS_SCOPE(op, size) ((void)0)
+#endif
 
 class BigInt;
+class ThreadPool;
+class MontgomeryContext;
 
 template<typename INT_T>
 struct int_is {
@@ -39,18 +66,230 @@ struct int_is {
     static constexpr bool value = (
         int_is<INT_T>::big_v || int_is<INT_T>::small_v || int_is<INT_T>::bool_v
     );
+    static constexpr bool arith_v = ( // native arithmetic operands (no bool)
+        int_is<INT_T>::big_v || int_is<INT_T>::small_v
+    );
 };
 
 std::ostream& operator<<(std::ostream& os, const BigInt& bigint);
 std::istream& operator>>(std::istream& is, const BigInt& bigint);
 
 class BigInt{
-    std::vector<uint32_t> data;
+public:
+#if BIGINT_LIMB_BITS == 64
+    typedef uint64_t limb_t;
+    __extension__ typedef unsigned __int128 dlimb_t;
+#else
+    typedef uint32_t limb_t;
+    typedef uint64_t dlimb_t;
+#endif
+    static constexpr unsigned limb_bits = BIGINT_LIMB_BITS;
+    static constexpr limb_t limb_max = ~static_cast<limb_t>(0);
+    // how a multiplication runs its Karatsuba, Toom and NTT tiers: parallel forks the
+    // sub-products and transform stages onto the thread pool; the result is the same either way
+    enum class Execution {serial, parallel};
+    // the operations stats() counts
+    enum class Operation {mul, sqr, div, from_string, to_string, gcd, powmod, root, prime_test, count};
+    static constexpr size_t size_classes = 32;
+private:
+    friend class MontgomeryContext;
+    friend class BarrettReducer;
+    friend class BigIntAccumulator;
+    // limbs, least significant first; values up to 4 limbs are stored inline
+    typedef SmallVector<limb_t, 4> limb_vector;
+    // working space of the kernels, taken from scratch_resource()
+    typedef std::pmr::vector<limb_t> scratch_vector;
+    limb_vector data;
     bool neg = false; // sign
     uint8_t def_base = 10; // default base
     int8_t chtoi(const char& ch) const;
     char itoch(const uint8_t i) const;
+    void to_digits(char* p_str, size_t len, const BigInt& x, const std::vector<BigInt>& pows, size_t i, uint8_t base) const;
+    void to_digits_word(char* p_str, size_t len, const limb_vector& x, limb_t chunk, uint8_t base) const;
+    static BigInt from_chunks(const limb_t* chunks, size_t n, std::vector<BigInt>& pows);
+
+    // low-level kernels over little-endian limb arrays (r may alias a or b limb by limb)
+    static limb_t add(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // an >= bn
+    static limb_t sub(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // an >= bn
+    static int cmp(const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    static limb_t mul_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+    static limb_t addmul_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+    static limb_t submul_1(limb_t* r, const limb_t* a, size_t n, limb_t b);
+    static limb_t div_2by1(limb_t& r, limb_t u1, limb_t u0, limb_t d, limb_t v);
+    static limb_t divrem_1(limb_t* q, const limb_t* a, size_t n, limb_t d);
+    static limb_t lshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt); // 0 < cnt < limb_bits, r >= a
+    static limb_t rshift(limb_t* r, const limb_t* a, size_t n, unsigned cnt); // 0 < cnt < limb_bits, r <= a
+    static BigInt from_limbs(const limb_t* p, size_t n);
+    limb_t div_1(limb_t d); // |*this| /= d, returns |*this| % d
+
+    // native integer operands, taken as a magnitude of at most 64 bits and a sign
+    static constexpr size_t native_max_limbs = 64 / BIGINT_LIMB_BITS;
+    template <typename INT_T>
+    static uint64_t magnitude(INT_T num, bool& is_neg);
+    static size_t native_limbs(limb_t* p, uint64_t mag); // returns the limb count, 0 for zero
+    BigInt& add_limbs(const limb_t* other, size_t size2, bool other_neg);
+    BigInt& add_native(uint64_t mag, bool mag_neg);
+    BigInt& mul_native(uint64_t mag, bool mag_neg);
+    uint64_t div_native(uint64_t mag, bool mag_neg); // truncating, returns |remainder|
+    uint64_t mod_native(uint64_t mag) const; // |*this| % mag
+    int cmp_native(uint64_t mag, bool mag_neg) const;
+    // *this += a*b*B^off (or -= when p_neg), the limbs grow once
+    BigInt& mul_acc(const limb_t* a, size_t an, const limb_t* b, size_t bn, size_t off, bool p_neg);
+
+    // multiplication engine (BigIntMul.cpp), r holds an+bn limbs and doesn't overlap a or b
+    static void mul(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // an >= bn
+    static void mul_basecase(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    static void mul_unbalanced(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    static void mul_karatsuba(limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+    static void mul_toom3(limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+    static void mul_toom4(limb_t* r, const limb_t* a, const limb_t* b, size_t n);
+    static void mul_ntt(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    static void toom3_interpolate(limb_t* r, size_t n, size_t k, BigInt& w0, BigInt& w1, BigInt& wm1, BigInt& wm2, BigInt& winf);
+    static void toom4_interpolate(limb_t* r, size_t n, size_t k, BigInt& w0, BigInt& w1, BigInt& wm1, BigInt& w2, BigInt& wm2, BigInt& wh, BigInt& winf);
+    // squaring, r holds 2*n limbs and doesn't overlap a
+    static void sqr(limb_t* r, const limb_t* a, size_t n);
+    static void sqr_basecase(limb_t* r, const limb_t* a, size_t n);
+    static void sqr_karatsuba(limb_t* r, const limb_t* a, size_t n);
+    static void sqr_toom3(limb_t* r, const limb_t* a, size_t n);
+    static void sqr_toom4(limb_t* r, const limb_t* a, size_t n);
+    static void mul_into(BigInt& res, const BigInt& int1, const BigInt& int2, Execution ex); // res may alias either
+    // mul() with the big tiers forked onto pool (null runs them here), then back to serial
+    static void mul_on(ThreadPool* pool, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    // w[i] = x[i] * y[i] (a square when x[i] == y[i]); with a pool the products run as parallel tasks
+    static void mul_batch(BigInt* w, const BigInt* const* x, const BigInt* const* y, size_t count);
+
+    // division engine (BigIntDiv.cpp), an >= bn, b[bn-1] != 0, q holds an-bn+1 limbs, r holds bn limbs
+    static void divrem(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    static void divrem_knuth(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+    // truncating a / b; q or r may be null, either may alias a or b
+    static void divmod(BigInt* q, BigInt* r, const BigInt& a, const BigInt& b);
+    // the same on non-negative BigInts
+    static BigInt low_limbs(const BigInt& x, size_t n);
+    static void div_basecase(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b);
+    static void div_bz(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b);
+    static void div_2n1n(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b, size_t n);
+    static void div_3n2n(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b, size_t n);
+    static void div_newton(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b);
+    static BigInt reciprocal(const BigInt& d, size_t k); // floor(2^(limb_bits*k) / d), k >= d limbs
+    static BigInt reciprocal_approx(const BigInt& d, size_t k);
+
+    // batch operations (BigIntBatch.cpp)
+    static ThreadPool* thread_pool(); // nullptr when thread_count < 2
+    static size_t total_limbs(const BigInt* const* v, size_t n);
+    static BigInt product_tree(const BigInt* const* v, size_t n, ThreadPool* pool);
+    static BigInt sum_tree(const BigInt* const* v, size_t n, ThreadPool* pool, size_t parts);
+
+    // number theory helpers (BigIntFactorial.cpp, BigIntRoot.cpp)
+    static std::vector<uint32_t> primes_up_to(uint64_t n); // sieve of Eratosthenes
+    uint64_t bits_at(size_t shift) const; // (|*this| >> shift) mod 2^64
+    double mantissa() const; // |*this| / 2^(bit_size()-1), in [1, 2); *this != 0
+    // m > 0: floor(m^(1/k)) with pw = root^k, and whether m == root^k (m has `twos` trailing zero bits)
+    static BigInt root_floor(const BigInt& m, uint64_t k, BigInt& pw);
+    static bool root_exact(const BigInt& m, uint64_t k, uint64_t twos, BigInt& root);
+
+    // gcd engine (BigIntGcd.cpp) on a > b >= 0
+    struct GcdMatrix; // (a, b) before the steps = matrix * (a, b) after them
+    // Lehmer: the steps the leading 60 bits agree on as n = [[A, B], [C, D]] with
+    // (a, b) <- (A*a + B*b, C*a + D*b), returns their count
+    static int lehmer_matrix(const BigInt& a, const BigInt& b, int64_t (&n)[4]);
+    static void apply_lehmer(const int64_t (&n)[4], BigInt& a, BigInt& b);
+    // half-gcd: steps until b has at most half the bits a came in with
+    static void hgcd(BigInt& a, BigInt& b, GcdMatrix& m);
+    // down to (gcd, 0); xa and xb, if given, go through the same steps as a and b
+    static void gcd_core(BigInt& a, BigInt& b, BigInt* xa, BigInt* xb);
+
+    // primality (BigIntPrime.cpp) on odd n > 3
+    static const std::vector<uint32_t>& small_primes(); // the odd primes trial division tries
+    static int trial_divide(const BigInt& n, uint64_t bound); // 0 composite, 1 prime, -1 undecided
+    static bool strong_probable_prime(const BigInt& n, const BigInt& base, const MontgomeryContext& ctx); // Miller-Rabin
+    static bool lucas_probable_prime(const BigInt& n); // extra strong, Baillie's parameters
+    static bool prime_test(const BigInt& n, int rounds, bool trial); // any n > 0
+    static void prime_test_tree(const BigInt* const* v, char* res, size_t n, int rounds, ThreadPool* pool);
+
+#ifdef BIGINT_STATS
+    // times one operation and counts it (BigIntStats.cpp), sized by its largest operand
+    // or, given a BigInt, by that one at the end
+    class StatsScope {
+        Operation op;
+        size_t limbs;
+        const BigInt* result;
+        uint64_t start, allocations, bytes;
+    public:
+        StatsScope(Operation op, size_t limbs);
+        StatsScope(Operation op, const BigInt* result);
+        ~StatsScope();
+        StatsScope(const StatsScope&) = delete;
+        StatsScope& operator=(const StatsScope&) = delete;
+    };
+#endif
 public:
+    // multiplication and squaring crossover thresholds (in limbs), tunable at runtime
+    static size_t karatsuba_threshold;
+    static size_t toom3_threshold;
+    static size_t toom4_threshold;
+    static size_t ntt_threshold;
+    static size_t sqr_karatsuba_threshold;
+    static size_t sqr_toom3_threshold;
+    static size_t sqr_toom4_threshold;
+    // division crossover thresholds (in limbs of the divisor and of the quotient)
+    static size_t bz_threshold;
+    static size_t newton_threshold;
+    // below this many limbs radix conversion runs word at a time, above it divide and conquer
+    static size_t radix_threshold;
+    // from this many limbs on gcd halves the operands with the half-gcd instead of Lehmer steps
+    static size_t hgcd_threshold;
+    // threads of the pool behind the batch operations and parallel multiplication (1 runs
+    // everything on the calling thread), change it only while no computation is running;
+    // pieces of work with operands of at least parallel_threshold limbs are forked
+    static size_t thread_count;
+    static size_t parallel_threshold;
+    // policy of *, *= and square(), serial by default; multiplied() picks one per call
+    static Execution execution;
+
+    // while a MemoryScope is alive the limbs of BigInts created on this thread come from res,
+    // e.g. a std::pmr::monotonic_buffer_resource that is dropped in one go afterwards;
+    // scopes nest. A value assigned to a BigInt created outside the scope is copied out of res,
+    // one returned or move-constructed from inside it keeps pointing into res
+    class MemoryScope {
+        std::pmr::memory_resource* prev;
+    public:
+        explicit MemoryScope(std::pmr::memory_resource* res);
+        ~MemoryScope();
+        MemoryScope(const MemoryScope&) = delete;
+        MemoryScope& operator=(const MemoryScope&) = delete;
+    };
+    // per-thread pool the multiplication and division kernels take their scratch space from
+    static std::pmr::memory_resource* scratch_resource();
+
+    // operation statistics (BigIntStats.cpp), gathered only in builds with -DBIGINT_STATS and
+    // all zero otherwise. Every thread counts into its own block without locking, stats() adds
+    // up the blocks of all threads, running and finished. The time and allocations of an
+    // operation include those of the operations it runs on the way (a division's multiplications)
+#ifdef BIGINT_STATS
+    static constexpr bool stats_enabled = true;
+#else
+    static constexpr bool stats_enabled = false;
+#endif
+    struct OperationStats {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t allocations = 0; // limb buffers, from the heap or a MemoryScope
+        uint64_t bytes_allocated = 0;
+        // calls by the limb count n of the largest operand: sizes[i] counts 2^(i-1) <= n < 2^i
+        uint64_t sizes[size_classes] = {};
+    };
+    struct Stats {
+        OperationStats ops[static_cast<size_t>(Operation::count)];
+        // all limb buffers; a reallocation moves limbs already there (a growing push_back or resize)
+        uint64_t allocations = 0;
+        uint64_t reallocations = 0;
+        uint64_t bytes_allocated = 0;
+        const OperationStats& operator[](Operation op) const {return ops[static_cast<size_t>(op)];}
+        static const char* name(Operation op);
+    };
+    static Stats stats();
+    static void reset_stats(); // stats() counts from here on
+
     BigInt();
     BigInt(const BigInt& other);
     BigInt(const BigInt& other, const char& sign);
@@ -79,12 +318,23 @@ public:
 
     BigInt& operator+=(const BigInt& other) & ;
     BigInt& operator-=(const BigInt& other) & ;
-    // BigInt& operator+=(const uint64_t& other);
 
     BigInt& operator*=(const BigInt& other) & ;
     BigInt& operator/=(const BigInt& other) & ;
     BigInt& operator%=(const BigInt& other) & ;
 
+    // native integer operands go straight to the single-limb kernels
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& operator+=(INT_T other) & ;
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& operator-=(INT_T other) & ;
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& operator*=(INT_T other) & ;
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& operator/=(INT_T other) & ;
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& operator%=(INT_T other) & ;
+
     BigInt& operator>>=(uint64_t shift) & ;
     BigInt& operator<<=(uint64_t shift) & ;
 
@@ -95,16 +345,26 @@ public:
 
 
     BigInt operator+() const;
-    BigInt operator-() const;
+    BigInt operator-() const & ;
+    BigInt operator-() && ;
+    // the rvalue overloads hand a temporary's limbs on to the result
     friend BigInt operator+(const BigInt& int1, const BigInt& int2);
+    friend BigInt operator+(BigInt&& int1, const BigInt& int2);
+    friend BigInt operator+(const BigInt& int1, BigInt&& int2);
+    friend BigInt operator+(BigInt&& int1, BigInt&& int2);
     friend BigInt operator-(const BigInt& int1, const BigInt& int2);
+    friend BigInt operator-(BigInt&& int1, const BigInt& int2);
+    friend BigInt operator-(const BigInt& int1, BigInt&& int2);
+    friend BigInt operator-(BigInt&& int1, BigInt&& int2);
 
     friend BigInt operator*(const BigInt& int1, const BigInt& int2);
     friend BigInt operator/(const BigInt& int1, const BigInt& int2);
+    friend BigInt operator/(BigInt&& int1, const BigInt& int2);
     friend BigInt operator%(const BigInt& int1, const BigInt& int2);
+    friend BigInt operator%(BigInt&& int1, const BigInt& int2);
 
-    friend BigInt operator>>(const BigInt big_int, uint64_t shift);
-    friend BigInt operator<<(const BigInt big_int, uint64_t shift);
+    friend BigInt operator>>(BigInt big_int, uint64_t shift);
+    friend BigInt operator<<(BigInt big_int, uint64_t shift);
 
 
     friend bool operator<(const BigInt& int1, const BigInt& int2);
@@ -114,23 +374,98 @@ public:
     friend bool operator==(const BigInt& int1, const BigInt& int2);
     friend bool operator!=(const BigInt& int1, const BigInt& int2);
 
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator%(const BigInt& int1, INT_T int2);
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator<(const BigInt& int1, INT_T int2);
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator>(const BigInt& int1, INT_T int2);
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator<=(const BigInt& int1, INT_T int2);
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator>=(const BigInt& int1, INT_T int2);
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator==(const BigInt& int1, INT_T int2);
+    template <typename INT_T>
+    friend typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator!=(const BigInt& int1, INT_T int2);
+
 
     void from_string(std::string& str, uint8_t base=0) & ;
     void from_cstr(const char* p_str, uint8_t base=0) & ;
     void from_char(const char& ch) & ;
     std::string to_string(uint8_t base=0) const;
+
+    // product and sum of a range of BigInts through balanced binary trees: the factors
+    // meet in similar sizes, so the fast multiplications are used; independent subtrees
+    // run on the thread pool (a forked tree works on the global heap, not in a MemoryScope)
+    template <typename ITER>
+    static BigInt product(ITER first, ITER last);
+    template <typename RANGE>
+    static BigInt product(const RANGE& values);
+    template <typename ITER>
+    static BigInt sum(ITER first, ITER last);
+    template <typename RANGE>
+    static BigInt sum(const RANGE& values);
+    // n!, n choose k (0 for k > n) and the product of the primes up to n (BigIntFactorial.cpp):
+    // products of sieved prime powers, so the work lands in balanced multiplications
+    static BigInt factorial(uint64_t n);
+    static BigInt binomial(uint64_t n, uint64_t k);
+    static BigInt primorial(uint64_t n);
     char* to_cstr(char* p_str, uint8_t base=0) const;
 
     BigInt& plus_minus_op(const BigInt& other, const char& sign);
+    // fused multiply-accumulate: no temporary product, the result grows once
+    BigInt& addmul(const BigInt& int1, const BigInt& int2) & ; // *this += int1 * int2
+    BigInt& submul(const BigInt& int1, const BigInt& int2) & ; // *this -= int1 * int2
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& addmul(const BigInt& int1, INT_T int2) & ;
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& submul(const BigInt& int1, INT_T int2) & ;
+    BigInt& add_shifted(const BigInt& other, uint64_t shift) & ; // *this += other << shift
+    BigInt& sub_shifted(const BigInt& other, uint64_t shift) & ; // *this -= other << shift
     BigInt& div(const BigInt& other, BigInt& remain);
+    // O(n) division by a native integer; the remainder takes the sign of *this
+    // (for unsigned INT_T it's the magnitude)
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigInt& div(INT_T other, INT_T& remain);
     friend BigInt divided(const BigInt& int1, const BigInt& int2, BigInt& remain);
+    friend BigInt multiplied(const BigInt& int1, const BigInt& int2, Execution ex);
+    // greatest common divisor (>= 0, BigIntGcd.cpp); xgcd also finds int1*x + int2*y == gcd,
+    // modinv(int1, mod) is in [0, mod) and throws unless mod > 0 and gcd(int1, mod) == 1
+    friend BigInt gcd(const BigInt& int1, const BigInt& int2);
+    friend BigInt xgcd(const BigInt& int1, const BigInt& int2, BigInt& x, BigInt& y);
+    friend BigInt modinv(const BigInt& int1, const BigInt& mod);
 
     size_t bit_size() const;
     const BigInt abs() const;
+    BigInt square() const;
+    BigInt square(Execution ex) const;
+    // floor of the k-th root of |*this| with the sign of *this (negative numbers have odd roots
+    // only), remain = *this - root^k; Newton's iteration from an estimate of the top bits,
+    // doubling the precision, so the early steps run on short operands
+    BigInt isqrt() const;
+    BigInt isqrt(BigInt& remain) const;
+    BigInt iroot(uint64_t k) const;
+    BigInt iroot(uint64_t k, BigInt& remain) const;
+    // *this == root^k for some k >= 2, k is the largest such exponent
+    // (0 and 1 give themselves with k = 2, -1 gives itself with k = 3)
+    bool is_perfect_power() const;
+    bool is_perfect_power(BigInt& root, uint64_t& k) const;
+    // Baillie-PSW (Miller-Rabin to base 2 and an extra strong Lucas test; no counterexample is known,
+    // none exists below 2^64) and `rounds` more Miller-Rabin bases, after trial division by a
+    // table of small primes. Numbers below 2 are not prime
+    bool is_probable_prime(int rounds=0) const;
+    BigInt next_prime(int rounds=0) const; // the smallest probable prime > *this
+    // one result per candidate, the candidates spread over the thread pool
+    static std::vector<bool> are_probable_primes(const std::vector<BigInt>& candidates, int rounds=0);
     bool is_valid() const;
     void set_def_base(uint8_t base);
     uint8_t get_def_base() const;
 };
+// visible to ordinary lookup too, so native arguments convert
+BigInt gcd(const BigInt& int1, const BigInt& int2);
+BigInt xgcd(const BigInt& int1, const BigInt& int2, BigInt& x, BigInt& y);
+BigInt modinv(const BigInt& int1, const BigInt& mod);
 #include "BigInt.tpp"
 
 #endif // BigInt_HPP
@@ -3,44 +3,254 @@
 
 #include "BigInt.hpp"
 #include <type_traits>
+#include <iterator>
 
 //template <typename INT_T, class=typename std::enable_if<is_int<INT_T>>::type>
-template <typename INT_T, typename std::enable_if<int_is<INT_T>::value, bool>::type = true>
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::value, bool>::type>
 BigInt::BigInt(INT_T num) {
     operator=(num);
 }
 
-template <typename SMALL_INT_T, typename std::enable_if<int_is<SMALL_INT_T>::small_v, bool>::type = true>
+template <typename SMALL_INT_T, typename std::enable_if<int_is<SMALL_INT_T>::small_v, bool>::type>
 BigInt& BigInt::operator=(SMALL_INT_T num) & {
     if (num < 0){
-        num = ~num+1;
-        operator=(static_cast<uint32_t>(num));
+        // negated in unsigned arithmetic, which also covers the minimum of the type
+        operator=(static_cast<uint32_t>(0u - static_cast<uint32_t>(num)));
         neg = true;
     } else {
         data.clear();
         neg = false;
         if (num){
-            data.push_back(static_cast<uint32_t>(num));
+            data.push_back(static_cast<limb_t>(num));
         }
     }
     return *this;
 }
 
-template <typename BIG_INT_T, typename std::enable_if<int_is<BIG_INT_T>::big_v, bool>::type = true>
+template <typename BIG_INT_T, typename std::enable_if<int_is<BIG_INT_T>::big_v, bool>::type>
 BigInt& BigInt::operator=(BIG_INT_T num) & {
     if (num < 0){
-        num = ~num+1;
-        operator=(static_cast<uint64_t>(num));
+        operator=(static_cast<uint64_t>(0u - static_cast<uint64_t>(num)));
         neg = true;
     } else {
         data.clear();
         neg = false;
-        while(num){
-            data.push_back(static_cast<uint32_t>(num));
-            num >>= 32;
+        while(num){ // a single limb when limbs are 64-bit
+            data.push_back(static_cast<limb_t>(num));
+            num >>= limb_bits/2; // two half steps: shifting by the full width is undefined
+            num >>= limb_bits/2;
         }
     }
     return *this;
 }
 
+template <typename ITER>
+BigInt BigInt::product(ITER first, ITER last){
+    static_assert(std::is_same<typename std::decay<decltype(*first)>::type, BigInt>::value, "product() takes a range of BigInt");
+    std::vector<const BigInt*> v;
+    for (; first != last; ++first) v.push_back(&*first);
+    return product_tree(v.data(), v.size(), thread_pool());
+}
+template <typename RANGE>
+BigInt BigInt::product(const RANGE& values){
+    return product(std::begin(values), std::end(values));
+}
+template <typename ITER>
+BigInt BigInt::sum(ITER first, ITER last){
+    static_assert(std::is_same<typename std::decay<decltype(*first)>::type, BigInt>::value, "sum() takes a range of BigInt");
+    std::vector<const BigInt*> v;
+    for (; first != last; ++first) v.push_back(&*first);
+    ThreadPool* pool = thread_pool();
+    return sum_tree(v.data(), v.size(), pool, (pool ? thread_count : 1));
+}
+template <typename RANGE>
+BigInt BigInt::sum(const RANGE& values){
+    return sum(std::begin(values), std::end(values));
+}
+
+template <typename INT_T>
+uint64_t BigInt::magnitude(INT_T num, bool& is_neg){
+    // negated in unsigned arithmetic, which also covers the minimum of the type
+    is_neg = (num < 0);
+    return (is_neg ? (0u - static_cast<uint64_t>(num)) : static_cast<uint64_t>(num));
+}
+
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::operator+=(INT_T other) & {
+    bool other_neg;
+    uint64_t mag = magnitude(other, other_neg);
+    return add_native(mag, other_neg);
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::operator-=(INT_T other) & {
+    bool other_neg;
+    uint64_t mag = magnitude(other, other_neg);
+    return add_native(mag, !other_neg);
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::operator*=(INT_T other) & {
+    bool other_neg;
+    uint64_t mag = magnitude(other, other_neg);
+    return mul_native(mag, other_neg);
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::operator/=(INT_T other) & {
+    bool other_neg;
+    uint64_t mag = magnitude(other, other_neg);
+    div_native(mag, other_neg);
+    return *this;
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::operator%=(INT_T other) & {
+    bool other_neg, this_neg = neg;
+    uint64_t rem = mod_native(magnitude(other, other_neg));
+    operator=(rem);
+    neg = (this_neg && rem);
+    return *this;
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::addmul(const BigInt& int1, INT_T int2) & {
+    bool int2_neg;
+    limb_t p[native_max_limbs];
+    size_t pn = native_limbs(p, magnitude(int2, int2_neg));
+    return mul_acc(int1.data.data(), int1.data.size(), p, pn, 0, (int1.neg != int2_neg));
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::submul(const BigInt& int1, INT_T int2) & {
+    bool int2_neg;
+    limb_t p[native_max_limbs];
+    size_t pn = native_limbs(p, magnitude(int2, int2_neg));
+    return mul_acc(int1.data.data(), int1.data.size(), p, pn, 0, (int1.neg == int2_neg));
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigInt& BigInt::div(INT_T other, INT_T& remain){
+    bool other_neg, this_neg = neg;
+    uint64_t mag = magnitude(other, other_neg);
+    uint64_t rem = div_native(mag, other_neg);
+    // |rem| < |other|, so it fits INT_T with either sign; unsigned INT_T gets the magnitude
+    remain = ((this_neg && std::is_signed<INT_T>::value) ? -static_cast<INT_T>(rem) : static_cast<INT_T>(rem));
+    return *this;
+}
+
+// the BigInt operand is taken by value, so a temporary passes its limbs on to the result
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator+(BigInt int1, INT_T int2){
+    int1 += int2;
+    return int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator+(INT_T int1, BigInt int2){
+    int2 += int1;
+    return int2;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator-(BigInt int1, INT_T int2){
+    int1 -= int2;
+    return int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator-(INT_T int1, BigInt int2){
+    BigInt res(-std::move(int2));
+    res += int1;
+    return res;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator*(BigInt int1, INT_T int2){
+    int1 *= int2;
+    return int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator*(INT_T int1, BigInt int2){
+    int2 *= int1;
+    return int2;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator/(BigInt int1, INT_T int2){
+    int1 /= int2;
+    return int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator/(INT_T int1, const BigInt& int2){
+    BigInt res(int1);
+    res /= int2;
+    return res;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator%(const BigInt& int1, INT_T int2){
+    // the remainder is read off int1 without copying it
+    bool int2_neg;
+    uint64_t rem = int1.mod_native(BigInt::magnitude(int2, int2_neg));
+    BigInt res(rem);
+    res.neg = (int1.neg && rem);
+    res.def_base = int1.def_base;
+    return res;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, BigInt>::type operator%(INT_T int1, const BigInt& int2){
+    BigInt res(int1);
+    res %= int2;
+    return res;
+}
+
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator<(const BigInt& int1, INT_T int2){
+    bool int2_neg;
+    uint64_t mag = BigInt::magnitude(int2, int2_neg);
+    return int1.cmp_native(mag, int2_neg) < 0;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator>(const BigInt& int1, INT_T int2){
+    bool int2_neg;
+    uint64_t mag = BigInt::magnitude(int2, int2_neg);
+    return int1.cmp_native(mag, int2_neg) > 0;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator<=(const BigInt& int1, INT_T int2){
+    bool int2_neg;
+    uint64_t mag = BigInt::magnitude(int2, int2_neg);
+    return int1.cmp_native(mag, int2_neg) <= 0;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator>=(const BigInt& int1, INT_T int2){
+    bool int2_neg;
+    uint64_t mag = BigInt::magnitude(int2, int2_neg);
+    return int1.cmp_native(mag, int2_neg) >= 0;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator==(const BigInt& int1, INT_T int2){
+    bool int2_neg;
+    uint64_t mag = BigInt::magnitude(int2, int2_neg);
+    return int1.cmp_native(mag, int2_neg) == 0;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator!=(const BigInt& int1, INT_T int2){
+    bool int2_neg;
+    uint64_t mag = BigInt::magnitude(int2, int2_neg);
+    return int1.cmp_native(mag, int2_neg) != 0;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator<(INT_T int1, const BigInt& int2){
+    return int2 > int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator>(INT_T int1, const BigInt& int2){
+    return int2 < int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator<=(INT_T int1, const BigInt& int2){
+    return int2 >= int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator>=(INT_T int1, const BigInt& int2){
+    return int2 <= int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator==(INT_T int1, const BigInt& int2){
+    return int2 == int1;
+}
+template <typename INT_T>
+typename std::enable_if<int_is<INT_T>::arith_v, bool>::type operator!=(INT_T int1, const BigInt& int2){
+    return int2 != int1;
+}
+
 #endif
@@ -0,0 +1,102 @@
+#include "BigIntAccumulator.hpp"
+#include <algorithm>
+
+BigIntAccumulator::BigIntAccumulator(){}
+BigIntAccumulator::BigIntAccumulator(const BigInt& init){
+    add(init);
+}
+
+void BigIntAccumulator::normalize(){
+    // carries go up until every column but the top one holds a plain limb;
+    // the top one keeps the signed carry, so each column is back to a single term
+    sdlimb_t c = 0;
+    for (dlimb_t& col : cols){
+        sdlimb_t v = static_cast<sdlimb_t>(col) + c;
+        col = static_cast<limb_t>(v);
+        c = v >> limb_bits; // arithmetic shift, negative columns borrow from the next one
+    }
+    if (c) cols.push_back(static_cast<dlimb_t>(c));
+    pending = 1;
+}
+
+void BigIntAccumulator::add_limbs(const limb_t* p, size_t n, bool negative){
+    if (n == 0) return;
+    if (pending == max_pending) normalize();
+    ++pending;
+    if (cols.size() < n) cols.resize(n, 0);
+    dlimb_t* c = cols.data();
+    if (negative){
+        for (size_t i=0; i<n; ++i) c[i] -= p[i];
+    } else {
+        for (size_t i=0; i<n; ++i) c[i] += p[i];
+    }
+}
+
+void BigIntAccumulator::addmul_limbs(const limb_t* a, size_t an, const limb_t* b, size_t bn, bool negative){
+    if ((an == 0) || (bn == 0)) return;
+    if (an < bn){
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    prod.resize(an + bn);
+    BigInt::mul(prod.data(), a, an, b, bn);
+    add_limbs(prod.data(), an + bn - (prod[an+bn-1] == 0), negative);
+}
+
+BigIntAccumulator& BigIntAccumulator::add(const BigInt& x){
+    add_limbs(x.data.data(), x.data.size(), x.neg);
+    return *this;
+}
+BigIntAccumulator& BigIntAccumulator::sub(const BigInt& x){
+    add_limbs(x.data.data(), x.data.size(), !x.neg);
+    return *this;
+}
+BigIntAccumulator& BigIntAccumulator::addmul(const BigInt& a, const BigInt& b){
+    addmul_limbs(a.data.data(), a.data.size(), b.data.data(), b.data.size(), (a.neg != b.neg));
+    return *this;
+}
+BigIntAccumulator& BigIntAccumulator::submul(const BigInt& a, const BigInt& b){
+    addmul_limbs(a.data.data(), a.data.size(), b.data.data(), b.data.size(), (a.neg == b.neg));
+    return *this;
+}
+BigIntAccumulator& BigIntAccumulator::operator+=(const BigInt& x){
+    return add(x);
+}
+BigIntAccumulator& BigIntAccumulator::operator-=(const BigInt& x){
+    return sub(x);
+}
+
+BigInt BigIntAccumulator::result() const {
+    // one carry pass; a carry of -1 out of the top means the sum is negative
+    // and the limbs hold its two's complement
+    BigInt res;
+    BigInt::limb_vector& d = res.data;
+    d.resize(cols.size());
+    sdlimb_t c = 0;
+    for (size_t i=0; i<cols.size(); ++i){
+        sdlimb_t v = static_cast<sdlimb_t>(cols[i]) + c;
+        d[i] = static_cast<limb_t>(v);
+        c = v >> limb_bits;
+    }
+    while ((c != 0) && (c != -1)){
+        d.push_back(static_cast<limb_t>(c));
+        c >>= limb_bits;
+    }
+    if (c == -1){ // |sum| = B^size - d
+        limb_t carry = 1;
+        for (limb_t& x : d){
+            x = ~x + carry;
+            carry = (carry && (x == 0));
+        }
+        if (carry) d.push_back(1);
+        res.neg = true;
+    }
+    while (d.size() && (d.back() == 0)) d.pop_back();
+    if (d.empty()) res.neg = false;
+    return res;
+}
+
+void BigIntAccumulator::clear(){
+    cols.clear();
+    pending = 0;
+}
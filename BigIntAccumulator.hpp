@@ -0,0 +1,53 @@
+#ifndef BigIntAccumulator_HPP
+#define BigIntAccumulator_HPP
+
+#include <vector>
+#include "BigInt.hpp"
+
+// running sum of many BigInts in carry-save form: every limb position is a signed column
+// twice as wide as a limb, the terms are added or subtracted column by column without
+// carrying, trimming or a sign test; carries are resolved only when result() is asked for
+class BigIntAccumulator{
+    typedef BigInt::limb_t limb_t;
+    typedef BigInt::dlimb_t dlimb_t;
+#if BIGINT_LIMB_BITS == 64
+    __extension__ typedef __int128 sdlimb_t;
+#else
+    typedef int64_t sdlimb_t;
+#endif
+    static constexpr unsigned limb_bits = BigInt::limb_bits;
+    // every column takes at most this many limb-sized terms between two normalizations
+    static constexpr size_t max_pending = (static_cast<size_t>(1) << (limb_bits - 2));
+
+    std::vector<dlimb_t> cols; // two's complement columns, the value is sum(cols[i] * B^i)
+    size_t pending = 0; // limb-sized terms a column may hold since the last normalization
+    std::vector<limb_t> prod; // products are formed here, then added like any other term
+
+    void normalize();
+    void add_limbs(const limb_t* p, size_t n, bool negative);
+    void addmul_limbs(const limb_t* a, size_t an, const limb_t* b, size_t bn, bool negative);
+public:
+    BigIntAccumulator();
+    explicit BigIntAccumulator(const BigInt& init);
+
+    BigIntAccumulator& add(const BigInt& x);
+    BigIntAccumulator& sub(const BigInt& x);
+    BigIntAccumulator& addmul(const BigInt& a, const BigInt& b); // += a*b
+    BigIntAccumulator& submul(const BigInt& a, const BigInt& b); // -= a*b
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigIntAccumulator& add(INT_T x);
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigIntAccumulator& sub(INT_T x);
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigIntAccumulator& addmul(const BigInt& a, INT_T b);
+    template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type = true>
+    BigIntAccumulator& submul(const BigInt& a, INT_T b);
+    BigIntAccumulator& operator+=(const BigInt& x);
+    BigIntAccumulator& operator-=(const BigInt& x);
+
+    BigInt result() const; // the sum so far, the accumulator is left as it is
+    void clear();
+};
+#include "BigIntAccumulator.tpp"
+
+#endif // BigIntAccumulator_HPP
@@ -0,0 +1,39 @@
+#ifndef BigIntAccumulator_TPP
+#define BigIntAccumulator_TPP
+
+#include "BigIntAccumulator.hpp"
+
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigIntAccumulator& BigIntAccumulator::add(INT_T x){
+    bool x_neg;
+    limb_t p[BigInt::native_max_limbs];
+    size_t pn = BigInt::native_limbs(p, BigInt::magnitude(x, x_neg));
+    add_limbs(p, pn, x_neg);
+    return *this;
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigIntAccumulator& BigIntAccumulator::sub(INT_T x){
+    bool x_neg;
+    limb_t p[BigInt::native_max_limbs];
+    size_t pn = BigInt::native_limbs(p, BigInt::magnitude(x, x_neg));
+    add_limbs(p, pn, !x_neg);
+    return *this;
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigIntAccumulator& BigIntAccumulator::addmul(const BigInt& a, INT_T b){
+    bool b_neg;
+    limb_t p[BigInt::native_max_limbs];
+    size_t pn = BigInt::native_limbs(p, BigInt::magnitude(b, b_neg));
+    addmul_limbs(a.data.data(), a.data.size(), p, pn, (a.neg != b_neg));
+    return *this;
+}
+template <typename INT_T, typename std::enable_if<int_is<INT_T>::arith_v, bool>::type>
+BigIntAccumulator& BigIntAccumulator::submul(const BigInt& a, INT_T b){
+    bool b_neg;
+    limb_t p[BigInt::native_max_limbs];
+    size_t pn = BigInt::native_limbs(p, BigInt::magnitude(b, b_neg));
+    addmul_limbs(a.data.data(), a.data.size(), p, pn, (a.neg == b_neg));
+    return *this;
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include "BigInt.hpp"
+#include "BigIntAccumulator.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+size_t BigInt::thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+size_t BigInt::parallel_threshold = (limb_bits == 64) ? 1000 : 2000;
+
+ThreadPool* BigInt::thread_pool(){
+    // built on first use, rebuilt when thread_count has changed since
+    static std::mutex m;
+    static std::unique_ptr<ThreadPool> pool;
+    if (thread_count < 2) return nullptr;
+    std::lock_guard<std::mutex> lock(m);
+    if (!pool || (pool->size() != thread_count))
+        pool.reset(new ThreadPool(thread_count));
+    return pool.get();
+}
+
+size_t BigInt::total_limbs(const BigInt* const* v, size_t n){
+    size_t res = 0;
+    for (size_t i=0; i<n; ++i) res += v[i]->data.size();
+    return res;
+}
+
+BigInt BigInt::product_tree(const BigInt* const* v, size_t n, ThreadPool* pool){
+    if (n == 0) return BigInt(1);
+    if (n == 1) return *v[0];
+    if (n == 2) return *v[0] * *v[1];
+    size_t h = n/2;
+    if (pool && (total_limbs(v, n) >= parallel_threshold)){
+        // the halves, and so their product, live on the global heap: the second half may be
+        // built on a worker, which must not allocate from the MemoryScope of this thread
+        MemoryScope heap(nullptr);
+        BigInt left, right;
+        pool->invoke([&]{left = product_tree(v, h, pool);},
+                     [&]{MemoryScope heap(nullptr); right = product_tree(v+h, n-h, pool);});
+        return left * right;
+    }
+    BigInt left = product_tree(v, h, nullptr);
+    return left * product_tree(v+h, n-h, nullptr);
+}
+
+BigInt BigInt::sum_tree(const BigInt* const* v, size_t n, ThreadPool* pool, size_t parts){
+    // the range is cut into about `parts` pieces, each summed in carry-save form
+    if (pool && (parts > 1) && (n > 1) && (total_limbs(v, n) >= parallel_threshold)){
+        size_t h = n/2;
+        MemoryScope heap(nullptr); // as in product_tree
+        BigInt left, right;
+        pool->invoke([&]{left = sum_tree(v, h, pool, parts/2);},
+                     [&]{MemoryScope heap(nullptr); right = sum_tree(v+h, n-h, pool, parts - parts/2);});
+        return std::move(left) + std::move(right);
+    }
+    BigIntAccumulator acc;
+    for (size_t i=0; i<n; ++i) acc.add(*v[i]);
+    return acc.result();
+}
@@ -0,0 +1,218 @@
+#include "BigInt.hpp"
+#include <cstdint>
+#include <algorithm>
+
+size_t BigInt::bz_threshold = (limb_bits == 64) ? 100 : 60;
+size_t BigInt::newton_threshold = (limb_bits == 64) ? 12000 : 16000;
+
+
+void BigInt::divrem(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    if (bn == 1){
+        r[0] = divrem_1(q, a, an, b[0]);
+    } else if ((bn < bz_threshold) || (an-bn < bz_threshold)){
+        divrem_knuth(q, r, a, an, b, bn);
+    } else {
+        MemoryScope scope(scratch_resource()); // the whole recursion works in scratch space
+        BigInt qq, rr;
+        if ((bn >= newton_threshold) && (an-bn >= newton_threshold))
+            div_newton(qq, rr, from_limbs(a, an), from_limbs(b, bn));
+        else
+            div_bz(qq, rr, from_limbs(a, an), from_limbs(b, bn));
+        std::fill(std::copy(qq.data.begin(), qq.data.end(), q), q+(an-bn+1), 0);
+        std::fill(std::copy(rr.data.begin(), rr.data.end(), r), r+bn, 0);
+    }
+}
+
+void BigInt::divrem_knuth(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    // Knuth, TAOCP vol. 2, 4.3.1, Algorithm D; bn >= 2
+    unsigned s = 0; // normalization shift: top bit of the divisor must be set
+    for (limb_t top = b[bn-1]; !(top >> (limb_bits-1)); top <<= 1) ++s;
+    scratch_vector vn(bn, scratch_resource()), un(an+1, scratch_resource());
+    if (s){
+        lshift(vn.data(), b, bn, s);
+        un[an] = lshift(un.data(), a, an, s);
+    } else {
+        std::copy(b, b+bn, vn.begin());
+        std::copy(a, a+an, un.begin());
+        un[an] = 0;
+    }
+    const dlimb_t base = static_cast<dlimb_t>(1) << limb_bits;
+    const dlimb_t v1 = vn[bn-1], v2 = vn[bn-2];
+    size_t j = an-bn+1;
+    while (j){
+        --j;
+        // estimate q[j] from the top two limbs, it is at most 2 too large
+        dlimb_t num = (static_cast<dlimb_t>(un[j+bn]) << limb_bits) | un[j+bn-1];
+        dlimb_t qhat = num / v1, rhat = num % v1;
+        while ((qhat >= base) || (qhat * v2 > ((rhat << limb_bits) | un[j+bn-2]))){
+            --qhat;
+            rhat += v1;
+            if (rhat >= base) break;
+        }
+        limb_t borrow = submul_1(un.data()+j, vn.data(), bn, static_cast<limb_t>(qhat));
+        if (un[j+bn] < borrow){ // qhat was still one too large, add back
+            --qhat;
+            un[j+bn] += add(un.data()+j, un.data()+j, bn, vn.data(), bn);
+        }
+        un[j+bn] -= borrow;
+        q[j] = static_cast<limb_t>(qhat);
+    }
+    if (s)
+        rshift(r, un.data(), bn, s);
+    else
+        std::copy(un.begin(), un.begin()+bn, r);
+}
+
+BigInt BigInt::low_limbs(const BigInt& x, size_t n){
+    return from_limbs(x.data.data(), std::min(n, x.data.size()));
+}
+
+void BigInt::div_basecase(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b){
+    size_t an = a.data.size(), bn = b.data.size();
+    if (cmp(a.data.data(), an, b.data.data(), bn) < 0){
+        q = 0;
+        r = a;
+        return;
+    }
+    scratch_vector qd(an-bn+1, scratch_resource()), rd(bn, scratch_resource());
+    if (bn == 1)
+        rd[0] = divrem_1(qd.data(), a.data.data(), an, b.data[0]);
+    else
+        divrem_knuth(qd.data(), rd.data(), a.data.data(), an, b.data.data(), bn);
+    q = from_limbs(qd.data(), qd.size());
+    r = from_limbs(rd.data(), rd.size());
+}
+
+void BigInt::div_bz(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b){
+    // Burnikel, Ziegler, "Fast Recursive Division" (1998), a, b > 0:
+    // b is padded to nn = j*2^k limbs (j <= bz_threshold) with its top bit set,
+    // a is then divided by blocks of nn limbs from the top
+    size_t n = b.data.size(), m = 1;
+    while (bz_threshold * m < n) m <<= 1;
+    size_t nn = ((n+m-1) / m) * m;
+    uint64_t sigma = limb_bits * (nn-n);
+    for (limb_t top = b.data.back(); !(top >> (limb_bits-1)); top <<= 1) ++sigma;
+    BigInt bb = b << sigma, aa = a << sigma;
+
+    size_t t = std::max<size_t>(aa.data.size() / nn + 1, 2); // the top block is below B^nn / 2 <= bb
+    auto block = [&](size_t i){ // i-th block of aa
+        size_t from = i * nn;
+        if (from >= aa.data.size()) return BigInt();
+        return from_limbs(aa.data.data() + from, std::min(nn, aa.data.size() - from));
+    };
+    scratch_vector qd((t-1) * nn, 0, scratch_resource());
+    BigInt z = aa >> (limb_bits * nn * (t-2)), qi;
+    size_t i = t-1;
+    while (i){
+        --i;
+        div_2n1n(qi, r, z, bb, nn); // qi < B^nn
+        std::copy(qi.data.begin(), qi.data.end(), qd.begin() + i*nn);
+        if (i){
+            z = r << (limb_bits * nn);
+            z += block(i-1);
+        }
+    }
+    q = from_limbs(qd.data(), qd.size());
+    r >>= sigma;
+}
+
+void BigInt::div_2n1n(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b, size_t n){
+    // a < b * B^n, b has n limbs and its top bit set
+    if ((n % 2) || (n < bz_threshold)){
+        div_basecase(q, r, a, b);
+        return;
+    }
+    size_t h = n/2;
+    BigInt q1, r1;
+    div_3n2n(q1, r1, a >> (limb_bits * h), b, h);
+    r1 <<= limb_bits * h;
+    r1 += from_limbs(a.data.data(), std::min(h, a.data.size()));
+    div_3n2n(q, r, r1, b, h);
+    q1 <<= limb_bits * h;
+    q += q1;
+}
+
+void BigInt::div_3n2n(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b, size_t n){
+    // a < b * B^n, b has 2*n limbs and its top bit set
+    BigInt b1 = b >> (limb_bits * n);
+    BigInt a12 = a >> (limb_bits * n);
+    if ((a >> (2 * limb_bits * n)) < b1){
+        div_2n1n(q, r, a12, b1, n);
+    } else { // q = B^n - 1
+        q = 1;
+        q <<= limb_bits * n;
+        --q;
+        r = a12 + b1;
+        r.sub_shifted(b1, limb_bits * n);
+    }
+    r <<= limb_bits * n;
+    r += low_limbs(a, n);
+    r.submul(q, low_limbs(b, n));
+    while (r.neg){ // at most twice
+        r += b;
+        --q;
+    }
+}
+
+BigInt BigInt::reciprocal(const BigInt& d, size_t k){
+    BigInt x = reciprocal_approx(d, k);
+    BigInt r = 1;
+    r <<= limb_bits * k;
+    r.submul(x, d);
+    while (r.neg){
+        --x;
+        r += d;
+    }
+    while (r >= d){
+        ++x;
+        r -= d;
+    }
+    return x;
+}
+
+BigInt BigInt::reciprocal_approx(const BigInt& d, size_t k){
+    // Newton's iteration x += x * (B^k - d*x) / B^k, every step doubles the number of correct limbs
+    size_t n = d.data.size(), p = k - n;
+    if (n > p+2){ // only the top p+2 limbs of d matter at this precision
+        size_t s = n - (p+2);
+        return reciprocal_approx(d >> (limb_bits * s), k - s);
+    }
+    BigInt x = 1;
+    x <<= limb_bits * k;
+    if ((p < newton_threshold) || (p < 4)){
+        BigInt q, r;
+        if ((n < bz_threshold) || (p < bz_threshold))
+            div_basecase(q, r, x, d);
+        else
+            div_bz(q, r, x, d);
+        return q;
+    }
+    // with x0 = y*B^(p-l), y ~ B^(n+l) / d:  x = x0 + y*e / B^(n+2l-p), e = B^(n+l) - d*y
+    size_t l = p/2 + 1;
+    BigInt y = reciprocal_approx(d, n + l);
+    BigInt e = 1;
+    e <<= limb_bits * (n + l);
+    e.submul(d, y);
+    size_t s = ((e.data.size() > l+2) ? e.data.size() - (l+2) : 0); // only the top limbs of e matter
+    e >>= limb_bits * s;
+    x = y << (limb_bits * (p - l));
+    x += (y * e) >> (limb_bits * (n + 2*l - p - s));
+    return x;
+}
+
+void BigInt::div_newton(BigInt& q, BigInt& r, const BigInt& a, const BigInt& b){
+    // a, b > 0, with x ~ B^m / b the estimate a*x / B^m is off by a unit at most
+    size_t m = a.data.size(), n = b.data.size();
+    size_t s = ((n > 2) ? n - 2 : 0); // the low limbs of a hardly change the estimate
+    q = (a >> (limb_bits * s)) * reciprocal_approx(b, m);
+    q >>= limb_bits * (m - s);
+    r = a - q * b;
+    while (r.neg){
+        r += b;
+        --q;
+    }
+    while (r >= b){
+        r -= b;
+        ++q;
+    }
+}
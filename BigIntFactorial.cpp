@@ -0,0 +1,113 @@
+#include "BigInt.hpp"
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// every function here reduces to a product of prime powers: the primes are packed into
+// 64-bit leaves and the leaves are multiplied by BigInt::product, a balanced tree
+
+static const uint64_t sieve_limit = 0xFFFFFFFF;
+
+std::vector<uint32_t> BigInt::primes_up_to(uint64_t n){
+    // sieve of Eratosthenes over the odd numbers, odd[i] stands for 2*i+1
+    std::vector<uint32_t> res;
+    if (n < 2) return res;
+    res.push_back(2);
+    std::vector<bool> odd(static_cast<size_t>((n+1)/2), true);
+    for (uint64_t i=1; i<odd.size(); ++i){
+        if (!odd[i]) continue;
+        uint64_t p = 2*i+1;
+        res.push_back(static_cast<uint32_t>(p));
+        for (uint64_t j=p*p/2; j<odd.size(); j+=p) odd[j] = false;
+    }
+    return res;
+}
+
+class FactorPacker {
+    std::vector<BigInt> leaves;
+    uint64_t acc = 1;
+public:
+    void mul(uint64_t f){
+        if (acc > UINT64_MAX / f){
+            leaves.emplace_back(acc);
+            acc = f;
+        } else {
+            acc *= f;
+        }
+    }
+    void mul_pow(uint64_t p, uint64_t e){
+        for (; e; --e) mul(p);
+    }
+    BigInt result(){
+        if (acc > 1) leaves.emplace_back(acc);
+        acc = 1;
+        return BigInt::product(leaves);
+    }
+};
+
+static BigInt odd_swing(uint64_t n, const std::vector<uint32_t>& primes){
+    // odd part of n! / (n/2)!^2: p appears sum((n / p^i) & 1) times
+    FactorPacker f;
+    for (size_t i=1; (i<primes.size()) && (primes[i]<=n); ++i){
+        uint64_t p = primes[i], e = 0;
+        for (uint64_t q=n/p; q; q/=p) e += (q & 1);
+        f.mul_pow(p, e);
+    }
+    return f.result();
+}
+
+static BigInt odd_factorial(uint64_t n, const std::vector<uint32_t>& primes){
+    // odd part of n! = (odd part of (n/2)!)^2 * odd part of swing(n)
+    if (n <= 20){
+        uint64_t f = 1;
+        for (uint64_t i=2; i<=n; ++i) f *= i;
+        while (!(f & 1)) f >>= 1;
+        return BigInt(f);
+    }
+    BigInt res = odd_factorial(n/2, primes).square();
+    res *= odd_swing(n, primes);
+    return res;
+}
+
+BigInt BigInt::factorial(uint64_t n){
+    // prime swing: n! = 2^(n - popcount(n)) * odd part
+    if (n > sieve_limit) throw std::invalid_argument("factorial argument too large");
+    std::vector<uint32_t> primes = primes_up_to(n);
+    BigInt res = odd_factorial(n, primes);
+    uint64_t twos = n;
+    for (uint64_t m=n; m; m>>=1) twos -= (m & 1);
+    res <<= twos;
+    return res;
+}
+
+BigInt BigInt::binomial(uint64_t n, uint64_t k){
+    if (k > n) return BigInt(0);
+    k = std::min(k, n-k);
+    if (k == 0) return BigInt(1);
+    if ((n > sieve_limit) || (k < n/64)){
+        // few factors: n*(n-1)*...*(n-k+1) / k!, without sieving up to n
+        FactorPacker f;
+        for (uint64_t i=0; i<k; ++i) f.mul(n-i);
+        return f.result() / factorial(k);
+    }
+    // Legendre: p appears sum(n/p^i - k/p^i - (n-k)/p^i) times
+    std::vector<uint32_t> primes = primes_up_to(n);
+    FactorPacker f;
+    for (uint32_t p32 : primes){
+        uint64_t p = p32, e = 0;
+        for (uint64_t q=p; ; q*=p){
+            e += n/q - k/q - (n-k)/q;
+            if (q > n/p) break;
+        }
+        f.mul_pow(p, e);
+    }
+    return f.result();
+}
+
+BigInt BigInt::primorial(uint64_t n){
+    if (n > sieve_limit) throw std::invalid_argument("primorial argument too large");
+    FactorPacker f;
+    for (uint32_t p : primes_up_to(n)) f.mul(p);
+    return f.result();
+}
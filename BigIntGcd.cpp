@@ -0,0 +1,256 @@
+#include "BigInt.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+size_t BigInt::hgcd_threshold = (limb_bits == 64) ? 60 : 120;
+
+struct BigInt::GcdMatrix {
+    // product of the steps' [[q, 1], [1, 0]], its determinant is -1 when odd
+    BigInt m00 = 1, m01 = 0, m10 = 0, m11 = 1;
+    bool odd = false;
+
+    bool identity() const {return m01.data.empty() && m10.data.empty();}
+    void step(const BigInt& q){
+        // *this *= [[q, 1], [1, 0]]
+        BigInt t = m01;
+        t.addmul(m00, q);
+        m01 = std::move(m00);
+        m00 = std::move(t);
+        t = m11;
+        t.addmul(m10, q);
+        m11 = std::move(m10);
+        m10 = std::move(t);
+        odd = !odd;
+    }
+    void mul_lehmer(const int64_t (&n)[4], int steps){
+        // *this *= n^-1 = [[|D|, |B|], [|C|, |A|]]
+        uint64_t a = static_cast<uint64_t>(n[0] < 0 ? -n[0] : n[0]), b = static_cast<uint64_t>(n[1] < 0 ? -n[1] : n[1]);
+        uint64_t c = static_cast<uint64_t>(n[2] < 0 ? -n[2] : n[2]), d = static_cast<uint64_t>(n[3] < 0 ? -n[3] : n[3]);
+        BigInt t0 = m00 * d, t1 = m00 * b;
+        t0.addmul(m01, c);
+        t1.addmul(m01, a);
+        m00 = std::move(t0);
+        m01 = std::move(t1);
+        t0 = m10 * d;
+        t1 = m10 * b;
+        t0.addmul(m11, c);
+        t1.addmul(m11, a);
+        m10 = std::move(t0);
+        m11 = std::move(t1);
+        if (steps & 1) odd = !odd;
+    }
+    void mul(const GcdMatrix& o){
+        BigInt t0 = m00 * o.m00, t1 = m00 * o.m01;
+        t0.addmul(m01, o.m10);
+        t1.addmul(m01, o.m11);
+        m00 = std::move(t0);
+        m01 = std::move(t1);
+        t0 = m10 * o.m00;
+        t1 = m10 * o.m01;
+        t0.addmul(m11, o.m10);
+        t1.addmul(m11, o.m11);
+        m10 = std::move(t0);
+        m11 = std::move(t1);
+        odd = (odd != o.odd);
+    }
+    void apply_inverse(BigInt& a, BigInt& b) const {
+        // (a, b) <- *this^-1 * (a, b) = +-(m11*a - m01*b, m00*b - m10*a)
+        BigInt na = m11 * a, nb = m00 * b;
+        na.submul(m01, b);
+        nb.submul(m10, a);
+        if (odd){
+            na = -std::move(na);
+            nb = -std::move(nb);
+        }
+        a = std::move(na);
+        b = std::move(nb);
+    }
+    void back_off(BigInt& a, BigInt& b){
+        // takes the last step back: *this = m' * [[q, 1], [1, 0]], (a, b) <- (q*a + b, a);
+        // q = m00 / m01 unless m' = [[1, 1], [1, 0]], where m01 == m11 == 1 and q = m10
+        BigInt q = ((m01 == m11) ? m10 : m00 / m01);
+        m00.submul(q, m01);
+        m10.submul(q, m11);
+        std::swap(m00, m01);
+        std::swap(m10, m11);
+        odd = !odd;
+        BigInt t = b;
+        t.addmul(a, q);
+        b = std::move(a);
+        a = std::move(t);
+    }
+};
+
+int BigInt::lehmer_matrix(const BigInt& a, const BigInt& b, int64_t (&n)[4]){
+    // Knuth's algorithm L: a quotient is taken only when both bounds of the leading bits
+    // agree on it, so every step is one of the full Euclidean sequence
+    size_t bits = a.bit_size();
+    size_t h = ((bits > 60) ? bits - 60 : 0);
+    int64_t ah = static_cast<int64_t>(a.bits_at(h)), bh = static_cast<int64_t>(b.bits_at(h));
+    int64_t A = 1, B = 0, C = 0, D = 1;
+    int steps = 0;
+    for (;;){
+        if ((bh + C <= 0) || (bh + D <= 0) || (ah + A < 0) || (ah + B < 0)) break;
+        int64_t q = (ah + A) / (bh + C);
+        if (q != (ah + B) / (bh + D)) break;
+        int64_t t = A - q*C;
+        A = C;
+        C = t;
+        t = B - q*D;
+        B = D;
+        D = t;
+        t = ah - q*bh;
+        ah = bh;
+        bh = t;
+        ++steps;
+    }
+    n[0] = A;
+    n[1] = B;
+    n[2] = C;
+    n[3] = D;
+    return steps;
+}
+
+void BigInt::apply_lehmer(const int64_t (&n)[4], BigInt& a, BigInt& b){
+    BigInt na = a * n[0], nb = a * n[2];
+    na.addmul(b, n[1]);
+    nb.addmul(b, n[3]);
+    a = std::move(na);
+    b = std::move(nb);
+}
+
+void BigInt::hgcd(BigInt& a, BigInt& b, GcdMatrix& m){
+    // the steps of the top bits are the steps of the whole numbers as long as the
+    // remainders stay well above the part cut off; the few last ones that may not be
+    // are taken back until the remainders are in order again
+    m = GcdMatrix();
+    size_t s = a.bit_size()/2;
+    if (a.data.size() >= hgcd_threshold){
+        // the top half brings a down to about 3/4 of its bits, the top of the rest to 1/2
+        for (int round=0; round<2; ++round){
+            size_t n = a.bit_size();
+            size_t k = ((round == 0) ? s : ((n < 2*s) ? 2*s - n : 0)); // the top n-k bits go in
+            if ((b.bit_size() <= s) || (k < limb_bits) || (k >= n)) break;
+            BigInt a1 = a >> k, b1 = b >> k;
+            GcdMatrix m1;
+            hgcd(a1, b1, m1);
+            if (m1.identity()) continue;
+            BigInt na = a, nb = b;
+            m1.apply_inverse(na, nb);
+            while (!m1.identity() && ((nb < 0) || (na <= nb))) m1.back_off(na, nb);
+            if (m1.identity()) continue;
+            a = std::move(na);
+            b = std::move(nb);
+            m.mul(m1);
+        }
+    }
+    while (b.bit_size() > s){
+        int64_t n[4];
+        int steps = lehmer_matrix(a, b, n);
+        if (steps){
+            apply_lehmer(n, a, b);
+            m.mul_lehmer(n, steps);
+        } else {
+            BigInt q, r;
+            divmod(&q, &r, a, b);
+            a = std::move(b);
+            b = std::move(r);
+            m.step(q);
+        }
+    }
+}
+
+void BigInt::gcd_core(BigInt& a, BigInt& b, BigInt* xa, BigInt* xb){
+    BIGINT_STATS_SCOPE(gcd, a.data.size());
+    while (!b.data.empty()){
+        if (b.data.size() >= hgcd_threshold){
+            GcdMatrix m;
+            hgcd(a, b, m);
+            if (!m.identity()){
+                if (xa) m.apply_inverse(*xa, *xb);
+                continue;
+            }
+        } else if (a.bit_size() <= 62){
+            // the rest in native words, the cofactors stay below 2^62
+            uint64_t u = a.bits_at(0), v = b.bits_at(0);
+            int64_t n[4] = {1, 0, 0, 1};
+            while (v){
+                uint64_t q = u / v, t = u - q*v;
+                u = v;
+                v = t;
+                int64_t iq = static_cast<int64_t>(q);
+                int64_t c = n[0] - iq*n[2], d = n[1] - iq*n[3];
+                n[0] = n[2];
+                n[1] = n[3];
+                n[2] = c;
+                n[3] = d;
+            }
+            a = BigInt(u);
+            b = BigInt(0);
+            if (xa) apply_lehmer(n, *xa, *xb);
+            return;
+        } else {
+            int64_t n[4];
+            if (lehmer_matrix(a, b, n)){
+                apply_lehmer(n, a, b);
+                if (xa) apply_lehmer(n, *xa, *xb);
+                continue;
+            }
+        }
+        // a quotient too big for the leading bits, or no progress: one full division
+        BigInt q, r;
+        divmod(&q, &r, a, b);
+        a = std::move(b);
+        b = std::move(r);
+        if (xa){
+            BigInt t = *xa;
+            t.submul(q, *xb);
+            *xa = std::move(*xb);
+            *xb = std::move(t);
+        }
+    }
+}
+
+BigInt gcd(const BigInt& int1, const BigInt& int2){
+    BigInt a = int1.abs(), b = int2.abs();
+    if (a < b) std::swap(a, b);
+    BigInt::gcd_core(a, b, nullptr, nullptr);
+    return a;
+}
+
+BigInt xgcd(const BigInt& int1, const BigInt& int2, BigInt& x, BigInt& y){
+    // the cofactor of the larger magnitude is tracked, the other one follows from it;
+    // x and y are written last, they may alias the inputs
+    BigInt a = int1.abs(), b = int2.abs();
+    bool swapped = (a < b);
+    if (swapped) std::swap(a, b);
+    BigInt big = a, small = b;
+    BigInt xa = 1, xb = 0;
+    BigInt::gcd_core(a, b, &xa, &xb);
+    BigInt ya = 0;
+    if (!small.data.empty()){
+        ya = a;
+        ya.submul(xa, big);
+        ya /= small;
+    }
+    if (swapped) std::swap(xa, ya);
+    if (int1.neg) xa = -std::move(xa);
+    if (int2.neg) ya = -std::move(ya);
+    x = std::move(xa);
+    y = std::move(ya);
+    return a;
+}
+
+BigInt modinv(const BigInt& int1, const BigInt& mod){
+    if (mod <= 0) throw std::invalid_argument("modinv: modulus must be positive");
+    // (mod, int1 mod mod) with the cofactor of the second tracked
+    BigInt a = mod, b = int1 % mod;
+    if (b < 0) b += mod;
+    BigInt xa = 0, xb = 1;
+    BigInt::gcd_core(a, b, &xa, &xb);
+    if (a != 1) throw std::invalid_argument("modinv: not invertible");
+    xa %= mod;
+    if (xa < 0) xa += mod;
+    return xa;
+}
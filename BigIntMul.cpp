@@ -0,0 +1,535 @@
+#include "BigInt.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+
+// measured separately for each limb width
+size_t BigInt::karatsuba_threshold = (limb_bits == 64) ? 24 : 28;
+size_t BigInt::toom3_threshold = (limb_bits == 64) ? 300 : 160;
+size_t BigInt::toom4_threshold = (limb_bits == 64) ? 600 : 1000;
+size_t BigInt::ntt_threshold = (limb_bits == 64) ? 4000 : 3000;
+size_t BigInt::sqr_karatsuba_threshold = (limb_bits == 64) ? 40 : 56;
+size_t BigInt::sqr_toom3_threshold = (limb_bits == 64) ? 400 : 200;
+size_t BigInt::sqr_toom4_threshold = (limb_bits == 64) ? 1200 : 1000;
+BigInt::Execution BigInt::execution = BigInt::Execution::serial;
+
+// pool the running multiplication forks onto, null while it runs serially; every task
+// writes to limbs of its own that the forking thread allocated, so the per-thread scratch
+// pools never see a buffer of another thread
+static thread_local ThreadPool* mul_pool = nullptr;
+
+class MulPoolScope {
+    ThreadPool* prev;
+public:
+    explicit MulPoolScope(ThreadPool* pool) : prev(mul_pool) {mul_pool = pool;}
+    ~MulPoolScope() {mul_pool = prev;}
+    MulPoolScope(const MulPoolScope&) = delete;
+    MulPoolScope& operator=(const MulPoolScope&) = delete;
+};
+
+template <class F, class G>
+static void fork_join(bool fork, const F& f, const G& g){
+    // f and g in parallel when there is a pool and the work is worth it
+    ThreadPool* pool = mul_pool;
+    if (pool && fork){
+        pool->invoke(f, [pool, &g]{
+            MulPoolScope scope(pool);
+            g();
+        });
+    } else {
+        f();
+        g();
+    }
+}
+
+static size_t digit_grain(){
+    // smallest piece of an element-wise NTT loop worth a task, in 32-bit digits
+    return BigInt::parallel_threshold * (BigInt::limb_bits/32);
+}
+
+template <class BODY>
+static void split_for(size_t first, size_t last, size_t piece, const BODY& body){
+    if (last - first <= piece){
+        body(first, last);
+        return;
+    }
+    size_t mid = first + (last - first)/2;
+    fork_join(true, [&]{split_for(first, mid, piece, body);}, [&]{split_for(mid, last, piece, body);});
+}
+
+template <class BODY>
+static void parallel_for(size_t n, const BODY& body){
+    // body(first, last) over [0, n): a few pieces per thread, none below digit_grain()
+    size_t piece = (mul_pool ? std::max(digit_grain(), n/(4*mul_pool->size()) + 1) : n);
+    split_for(0, n, std::max<size_t>(piece, 1), body);
+}
+
+// three-prime number-theoretic transform over 32-bit digits (64-bit limbs are split in halves),
+// every coefficient of the product is below min(an, bn)*2^64 < P1*P2*P3 ~ 2^90.5
+static const uint32_t ntt_p1 = 2013265921; // 15*2^27 + 1
+static const uint32_t ntt_p2 = 1811939329; // 27*2^26 + 1
+static const uint32_t ntt_p3 = 469762049;  // 7*2^26 + 1
+static const size_t ntt_max_size = static_cast<size_t>(1) << 26;
+
+template <uint32_t P>
+static uint32_t pow_mod(uint32_t b, uint64_t e){
+    uint64_t res = 1, t = b % P;
+    while (e){
+        if (e & 1) res = res * t % P;
+        t = t * t % P;
+        e >>= 1;
+    }
+    return static_cast<uint32_t>(res);
+}
+
+template <uint32_t P>
+static void ntt_roots(std::pmr::vector<uint32_t>& rt, size_t n, uint32_t w){
+    // rt[j] = w^j, j < n/2; every piece starts from its own power
+    rt.resize(n/2);
+    parallel_for(n/2, [&](size_t first, size_t last){
+        if (first == last) return;
+        rt[first] = pow_mod<P>(w, first);
+        for (size_t j=first+1; j<last; ++j)
+            rt[j] = static_cast<uint32_t>(static_cast<uint64_t>(rt[j-1]) * w % P);
+    });
+}
+
+template <uint32_t P>
+static void ntt_dif(uint32_t* f, size_t n, const uint32_t* rt, size_t step){
+    // decimation in frequency: natural order in, bit-reversed order out; rt[j*step] = w_n^j.
+    // With a pool the first stage is split up and the two halves it leaves are separate tasks
+    if (mul_pool && (n >= 2*digit_grain())){
+        size_t h = n/2;
+        parallel_for(h, [&](size_t first, size_t last){
+            for (size_t j=first; j<last; ++j){
+                uint32_t u = f[j], v = f[j+h];
+                f[j] = ((u+v >= P) ? u+v-P : u+v);
+                f[j+h] = static_cast<uint32_t>(static_cast<uint64_t>(u+P-v) * rt[j*step] % P);
+            }
+        });
+        fork_join(true, [&]{ntt_dif<P>(f, h, rt, 2*step);}, [&]{ntt_dif<P>(f+h, h, rt, 2*step);});
+        return;
+    }
+    for (size_t len=n/2; len; len>>=1, step<<=1){
+        for (size_t i=0; i<n; i+=2*len){
+            for (size_t j=0; j<len; ++j){
+                uint32_t u = f[i+j], v = f[i+j+len];
+                f[i+j] = ((u+v >= P) ? u+v-P : u+v); // 2*P < 2^32
+                f[i+j+len] = static_cast<uint32_t>(static_cast<uint64_t>(u+P-v) * rt[j*step] % P);
+            }
+        }
+    }
+}
+
+template <uint32_t P>
+static void ntt_dit(uint32_t* f, size_t n, const uint32_t* rt, size_t step){
+    // decimation in time: bit-reversed order in, natural order out; rt[j*step] = w_n^j.
+    // With a pool the two halves are separate tasks and the last stage is split up
+    if (mul_pool && (n >= 2*digit_grain())){
+        size_t h = n/2;
+        fork_join(true, [&]{ntt_dit<P>(f, h, rt, 2*step);}, [&]{ntt_dit<P>(f+h, h, rt, 2*step);});
+        parallel_for(h, [&](size_t first, size_t last){
+            for (size_t j=first; j<last; ++j){
+                uint32_t u = f[j];
+                uint32_t v = static_cast<uint32_t>(static_cast<uint64_t>(f[j+h]) * rt[j*step] % P);
+                f[j] = ((u+v >= P) ? u+v-P : u+v);
+                f[j+h] = ((u >= v) ? u-v : u+P-v);
+            }
+        });
+        return;
+    }
+    for (size_t len=1, s=step*(n/2); len<n; len<<=1, s>>=1){
+        for (size_t i=0; i<n; i+=2*len){
+            for (size_t j=0; j<len; ++j){
+                uint32_t u = f[i+j];
+                uint32_t v = static_cast<uint32_t>(static_cast<uint64_t>(f[i+j+len]) * rt[j*s] % P);
+                f[i+j] = ((u+v >= P) ? u+v-P : u+v);
+                f[i+j+len] = ((u >= v) ? u-v : u+P-v);
+            }
+        }
+    }
+}
+
+template <uint32_t P, uint32_t G>
+static void ntt_forward(uint32_t* f, size_t n){
+    std::pmr::vector<uint32_t> rt(BigInt::scratch_resource());
+    ntt_roots<P>(rt, n, pow_mod<P>(G, (P-1)/n));
+    ntt_dif<P>(f, n, rt.data(), 1);
+}
+
+template <uint32_t P, uint32_t G>
+static void ntt_inverse(uint32_t* f, size_t n){
+    // the result is not scaled by 1/n
+    std::pmr::vector<uint32_t> rt(BigInt::scratch_resource());
+    ntt_roots<P>(rt, n, pow_mod<P>(G, (P-1) - (P-1)/n));
+    ntt_dit<P>(f, n, rt.data(), 1);
+}
+
+template <uint32_t P, uint32_t G>
+static void ntt_mul_mod(uint32_t* res, const uint32_t* a, size_t an, const uint32_t* b, size_t bn, size_t n){
+    // res[0..an+bn-1) = coefficients of a*b modulo P, a square takes one forward transform
+    bool sq = (a == b) && (an == bn);
+    std::pmr::memory_resource* scratch = BigInt::scratch_resource();
+    std::pmr::vector<uint32_t> fa(n, 0, scratch), fb(sq ? 0 : n, 0, scratch);
+    auto transform = [n](std::pmr::vector<uint32_t>& f, const uint32_t* x, size_t xn){
+        parallel_for(xn, [&](size_t first, size_t last){
+            for (size_t i=first; i<last; ++i) f[i] = x[i] % P;
+        });
+        ntt_forward<P, G>(f.data(), n);
+    };
+    fork_join(!sq, [&]{transform(fa, a, an);}, [&]{if (!sq) transform(fb, b, bn);});
+    const uint32_t* fm = (sq ? fa.data() : fb.data());
+    uint64_t n_inv = pow_mod<P>(static_cast<uint32_t>(n % P), P-2);
+    parallel_for(n, [&](size_t first, size_t last){
+        for (size_t i=first; i<last; ++i)
+            fa[i] = static_cast<uint32_t>(static_cast<uint64_t>(fa[i]) * fm[i] % P * n_inv % P);
+    });
+    ntt_inverse<P, G>(fa.data(), n);
+    std::copy(fa.begin(), fa.begin() + (an+bn-1), res);
+}
+
+
+static void ntt_mul(uint32_t* r, const uint32_t* a, size_t an, const uint32_t* b, size_t bn){
+    // r[0..an+bn) = a*b on 32-bit digits, with a pool the three primes run side by side
+    size_t rn = an+bn-1, n = 1;
+    while (n < rn) n <<= 1;
+    std::pmr::memory_resource* scratch = BigInt::scratch_resource();
+    std::pmr::vector<uint32_t> r1(rn, scratch), r2(rn, scratch), r3(rn, scratch);
+    fork_join(true, [&]{ntt_mul_mod<ntt_p1, 31>(r1.data(), a, an, b, bn, n);}, [&]{
+        fork_join(true, [&]{ntt_mul_mod<ntt_p2, 13>(r2.data(), a, an, b, bn, n);},
+                        [&]{ntt_mul_mod<ntt_p3, 3>(r3.data(), a, an, b, bn, n);});
+    });
+
+    // Garner's CRT: x = x12 + P1*P2*t, x12 = r1 + P1*((r2-r1)/P1 mod P2)
+    const uint64_t p1_inv = pow_mod<ntt_p2>(ntt_p1 % ntt_p2, ntt_p2-2);
+    const uint64_t p12 = static_cast<uint64_t>(ntt_p1) * ntt_p2;
+    const uint64_t p12_inv = pow_mod<ntt_p3>(static_cast<uint32_t>(p12 % ntt_p3), ntt_p3-2);
+    uint64_t c0 = 0, c1 = 0, c2 = 0, s; // carry into the next three digits
+    for (size_t k=0; k<rn; ++k){
+        uint64_t x12 = r1[k] + static_cast<uint64_t>(ntt_p1) *
+            ((r2[k] + ntt_p2 - r1[k] % ntt_p2) * p1_inv % ntt_p2);
+        uint64_t t = (r3[k] + ntt_p3 - x12 % ntt_p3) * p12_inv % ntt_p3;
+        uint64_t lo = (p12 & 0xFFFFFFFF) * t, hi = (p12 >> 32) * t;
+        s = c0 + (x12 & 0xFFFFFFFF) + (lo & 0xFFFFFFFF);
+        r[k] = static_cast<uint32_t>(s);
+        s = (s >> 32) + c1 + (x12 >> 32) + (lo >> 32) + (hi & 0xFFFFFFFF);
+        c0 = (s & 0xFFFFFFFF);
+        s = (s >> 32) + c2 + (hi >> 32);
+        c1 = (s & 0xFFFFFFFF);
+        c2 = (s >> 32);
+    }
+    r[rn] = static_cast<uint32_t>(c0); // the product fits an+bn digits, c1 == c2 == 0
+}
+
+
+void BigInt::mul(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    // the second conditions are the minimal sizes the splits below are valid for
+    if ((a == b) && (an == bn)){
+        sqr(r, a, an);
+    } else if ((bn < karatsuba_threshold) || (bn < 2)){
+        mul_basecase(r, a, an, b, bn);
+    } else if ((bn >= ntt_threshold) && ((an+bn)*(limb_bits/32) <= ntt_max_size)){
+        mul_ntt(r, a, an, b, bn);
+    } else if (an != bn){
+        mul_unbalanced(r, a, an, b, bn);
+    } else if ((bn < toom3_threshold) || (bn < 9)){
+        mul_karatsuba(r, a, b, bn);
+    } else if ((bn < toom4_threshold) || (bn < 16)){
+        mul_toom3(r, a, b, bn);
+    } else {
+        mul_toom4(r, a, b, bn);
+    }
+}
+
+void BigInt::mul_on(ThreadPool* pool, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    MulPoolScope scope(pool);
+    mul(r, a, an, b, bn);
+}
+
+void BigInt::mul_batch(BigInt* w, const BigInt* const* x, const BigInt* const* y, size_t count){
+    // the limbs are allocated here, the tasks only fill them in
+    size_t total = 0;
+    for (size_t i=0; i<count; ++i){
+        size_t n = x[i]->data.size() + y[i]->data.size();
+        w[i].data.resize(((x[i]->data.empty() || y[i]->data.empty()) ? 0 : n));
+        total += n;
+    }
+    std::function<void(size_t, size_t)> run = [&](size_t first, size_t last){
+        if (last - first > 1){
+            size_t mid = first + (last - first)/2;
+            fork_join(true, [&]{run(first, mid);}, [&]{run(mid, last);});
+            return;
+        }
+        if (w[first].data.empty()) return;
+        const limb_vector& a = ((x[first]->data.size() >= y[first]->data.size()) ? x[first]->data : y[first]->data);
+        const limb_vector& b = ((&a == &x[first]->data) ? y[first]->data : x[first]->data);
+        mul(w[first].data.data(), a.data(), a.size(), b.data(), b.size());
+    };
+    if (mul_pool && (total >= parallel_threshold)){
+        run(0, count);
+    } else {
+        for (size_t i=0; i<count; ++i) run(i, i+1);
+    }
+    for (size_t i=0; i<count; ++i){
+        if (!w[i].data.empty() && (w[i].data.back() == 0x0)) w[i].data.pop_back();
+        w[i].neg = (!w[i].data.empty()) && (x[i]->neg != y[i]->neg);
+    }
+}
+
+void BigInt::mul_basecase(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    std::fill(r, r+an, 0);
+    for (size_t j=0; j<bn; ++j)
+        r[an+j] = addmul_1(r+j, a, an, b[j]);
+}
+
+void BigInt::mul_unbalanced(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    // an > bn: a is cut into bn-limb pieces, every piece is a balanced product
+    std::fill(r, r+an+bn, 0);
+    scratch_vector tmp(2*bn, scratch_resource());
+    size_t i = 0;
+    for (;i+bn<=an; i+=bn){
+        mul(tmp.data(), a+i, bn, b, bn);
+        add(r+i, r+i, 2*bn, tmp.data(), 2*bn); // r[i+bn..] is still zero, no carry out
+    }
+    if (i < an){
+        size_t rest = an - i;
+        mul(tmp.data(), b, bn, a+i, rest);
+        add(r+i, r+i, bn+rest, tmp.data(), bn+rest);
+    }
+}
+
+void BigInt::mul_karatsuba(limb_t* r, const limb_t* a, const limb_t* b, size_t n){
+    // a*b = z2*B^(2l) + (z1-z2-z0)*B^l + z0, z1 = (a0+a1)*(b0+b1)
+    size_t l = n/2, h = n - l; // h >= l
+    scratch_vector tmp(4*h+1, scratch_resource());
+    limb_t* sa = tmp.data();
+    limb_t* sb = sa + h;
+    limb_t* z1 = sb + h; // 2*h+1 limbs
+    limb_t ca = add(sa, a+l, h, a, l);
+    limb_t cb = add(sb, b+l, h, b, l);
+    // the three products fill disjoint limbs
+    bool fork = (2*n >= parallel_threshold);
+    fork_join(fork, [&]{mul(z1, sa, h, sb, h);}, [&]{
+        fork_join(fork, [&]{mul(r, a, l, b, l);}, // z0
+                        [&]{mul(r+2*l, a+l, h, b+l, h);}); // z2
+    });
+    z1[2*h] = 0;
+    // carries of the sums are multiplied separately, so z1 never grows past 2*h+1 limbs
+    if (ca) z1[2*h] += add(z1+h, z1+h, h, sb, h);
+    if (cb) z1[2*h] += add(z1+h, z1+h, h, sa, h);
+    if (ca && cb) ++z1[2*h];
+
+    sub(z1, z1, 2*h+1, r, 2*l);
+    sub(z1, z1, 2*h+1, r+2*l, 2*h);
+    size_t z1n = 2*h+1;
+    while (z1n && (z1[z1n-1] == 0)) --z1n; // z1 - z2 - z0 < B^(n+1)
+    add(r+l, r+l, 2*n-l, z1, z1n);
+}
+
+void BigInt::mul_toom3(limb_t* r, const limb_t* a, const limb_t* b, size_t n){
+    // evaluation at 0, 1, -1, -2, inf
+    MemoryScope scope(scratch_resource()); // no BigInt in here outlives the call
+    size_t k = (n+2)/3;
+    BigInt a0 = from_limbs(a, k), a1 = from_limbs(a+k, k), a2 = from_limbs(a+2*k, n-2*k);
+    BigInt b0 = from_limbs(b, k), b1 = from_limbs(b+k, k), b2 = from_limbs(b+2*k, n-2*k);
+
+    BigInt pa = a0 + a2, pb = b0 + b2;
+    BigInt pa1 = pa + a1, pb1 = pb + b1;
+    BigInt pam1 = pa - a1, pbm1 = pb - b1;
+    BigInt pam2 = ((pam1 + a2) << 1) - a0, pbm2 = ((pbm1 + b2) << 1) - b0;
+
+    const BigInt* x[] = {&a0, &pa1, &pam1, &pam2, &a2};
+    const BigInt* y[] = {&b0, &pb1, &pbm1, &pbm2, &b2};
+    BigInt w[5];
+    mul_batch(w, x, y, 5);
+    toom3_interpolate(r, n, k, w[0], w[1], w[2], w[3], w[4]);
+}
+
+void BigInt::toom3_interpolate(limb_t* r, size_t n, size_t k, BigInt& w0, BigInt& w1, BigInt& wm1, BigInt& wm2, BigInt& winf){
+    // Bodrato's interpolation sequence, r gets 2*n limbs
+    BigInt r3 = wm2 - w1;
+    r3.div_1(3);
+    BigInt r1 = (w1 - wm1) >> 1;
+    BigInt r2 = wm1 - w0;
+    r3 = ((r2 - r3) >> 1) + (winf << 1);
+    r2 += r1;
+    r2 -= winf;
+    r1 -= r3;
+
+    // all coefficients are non-negative now
+    std::fill(r, r+2*n, 0);
+    auto add_at = [&](const BigInt& x, size_t offset){
+        add(r+offset, r+offset, 2*n-offset, x.data.data(), x.data.size());
+    };
+    add_at(w0, 0);
+    add_at(r1, k);
+    add_at(r2, 2*k);
+    add_at(r3, 3*k);
+    add_at(winf, 4*k);
+}
+
+void BigInt::mul_toom4(limb_t* r, const limb_t* a, const limb_t* b, size_t n){
+    // evaluation at 0, 1, -1, 2, -2, 1/2, inf
+    MemoryScope scope(scratch_resource()); // no BigInt in here outlives the call
+    size_t k = (n+3)/4;
+    BigInt a0 = from_limbs(a, k), a1 = from_limbs(a+k, k), a2 = from_limbs(a+2*k, k), a3 = from_limbs(a+3*k, n-3*k);
+    BigInt b0 = from_limbs(b, k), b1 = from_limbs(b+k, k), b2 = from_limbs(b+2*k, k), b3 = from_limbs(b+3*k, n-3*k);
+
+    BigInt ea = a0 + a2, oa = a1 + a3;
+    BigInt eb = b0 + b2, ob = b1 + b3;
+    BigInt pa1 = ea + oa, pam1 = ea - oa;
+    BigInt pb1 = eb + ob, pbm1 = eb - ob;
+    ea = a0 + (a2 << 2);
+    oa = (a1 << 1) + (a3 << 3);
+    eb = b0 + (b2 << 2);
+    ob = (b1 << 1) + (b3 << 3);
+    BigInt pa2 = ea + oa, pam2 = ea - oa;
+    BigInt pb2 = eb + ob, pbm2 = eb - ob;
+    BigInt pah = (a0 << 3) + (a1 << 2) + (a2 << 1) + a3; // 8*p(1/2)
+    BigInt pbh = (b0 << 3) + (b1 << 2) + (b2 << 1) + b3;
+
+    const BigInt* x[] = {&a0, &pa1, &pam1, &pa2, &pam2, &pah, &a3};
+    const BigInt* y[] = {&b0, &pb1, &pbm1, &pb2, &pbm2, &pbh, &b3};
+    BigInt w[7];
+    mul_batch(w, x, y, 7);
+    toom4_interpolate(r, n, k, w[0], w[1], w[2], w[3], w[4], w[5], w[6]);
+}
+
+void BigInt::toom4_interpolate(limb_t* r, size_t n, size_t k, BigInt& w0, BigInt& w1, BigInt& wm1, BigInt& w2, BigInt& wm2, BigInt& wh, BigInt& winf){
+    // w(t) = c0 + c1*t + ... + c6*t^6, c0 = w0, c6 = winf, r gets 2*n limbs
+    BigInt o1 = (w1 - wm1) >> 1; // c1 + c3 + c5
+    BigInt o2 = (w2 - wm2) >> 2; // c1 + 4*c3 + 16*c5
+    BigInt e1 = ((w1 + wm1) >> 1) - w0 - winf; // c2 + c4
+    BigInt e2 = ((((w2 + wm2) >> 1) - w0 - (winf << 6)) >> 2); // c2 + 4*c4
+    BigInt c4 = e2 - e1;
+    c4.div_1(3);
+    BigInt c2 = e1 - c4;
+    BigInt oh = (wh - (w0 << 6) - (c2 << 4) - (c4 << 2) - winf) >> 1; // 16*c1 + 4*c3 + c5
+    BigInt s = o2 - o1; // 3*c3 + 15*c5
+    s.div_1(3);
+    BigInt t = oh - o1; // 15*c1 + 3*c3
+    t.div_1(3);
+    BigInt c3 = (o1 << 2) + o1 - s - t;
+    c3.div_1(3);
+    BigInt c5 = s - c3;
+    c5.div_1(5);
+    BigInt c1 = t - c3;
+    c1.div_1(5);
+
+    std::fill(r, r+2*n, 0);
+    auto add_at = [&](const BigInt& x, size_t offset){
+        add(r+offset, r+offset, 2*n-offset, x.data.data(), x.data.size());
+    };
+    add_at(w0, 0);
+    add_at(c1, k);
+    add_at(c2, 2*k);
+    add_at(c3, 3*k);
+    add_at(c4, 4*k);
+    add_at(c5, 5*k);
+    add_at(winf, 6*k);
+}
+
+void BigInt::mul_ntt(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn){
+    // limbs to 32-bit digits and back, least significant half first
+    const size_t w = limb_bits/32;
+    bool sq = (a == b) && (an == bn);
+    std::pmr::memory_resource* scratch = scratch_resource();
+    std::pmr::vector<uint32_t> da(an*w, scratch), db(sq ? 0 : bn*w, scratch), dr((an+bn)*w, scratch);
+    for (size_t i=0; i<an*w; ++i) da[i] = static_cast<uint32_t>(a[i/w] >> (32*(i%w)));
+    for (size_t i=0; i<db.size(); ++i) db[i] = static_cast<uint32_t>(b[i/w] >> (32*(i%w)));
+    ntt_mul(dr.data(), da.data(), an*w, (sq ? da.data() : db.data()), bn*w);
+    std::fill(r, r+an+bn, 0);
+    for (size_t i=0; i<(an+bn)*w; ++i) r[i/w] |= static_cast<limb_t>(dr[i]) << (32*(i%w));
+}
+
+
+void BigInt::sqr(limb_t* r, const limb_t* a, size_t n){
+    // the same tiers as mul, every cross product a_i*a_j is computed once
+    if ((n < sqr_karatsuba_threshold) || (n < 2)){
+        sqr_basecase(r, a, n);
+    } else if ((n >= ntt_threshold) && (2*n*(limb_bits/32) <= ntt_max_size)){
+        mul_ntt(r, a, n, a, n);
+    } else if ((n < sqr_toom3_threshold) || (n < 9)){
+        sqr_karatsuba(r, a, n);
+    } else if ((n < sqr_toom4_threshold) || (n < 16)){
+        sqr_toom3(r, a, n);
+    } else {
+        sqr_toom4(r, a, n);
+    }
+}
+
+void BigInt::sqr_basecase(limb_t* r, const limb_t* a, size_t n){
+    // a^2 = 2 * sum(a_i*a_j, i < j) + sum(a_i^2)
+    std::fill(r, r+2*n, 0);
+    for (size_t i=0; i+1<n; ++i)
+        r[n+i] = addmul_1(r+2*i+1, a+i+1, n-i-1, a[i]);
+    lshift(r, r, 2*n, 1); // the cross sum is below B^(2n) / 2
+    dlimb_t t = 0;
+    for (size_t i=0; i<n; ++i){
+        dlimb_t p = static_cast<dlimb_t>(a[i]) * a[i];
+        t += static_cast<dlimb_t>(r[2*i]) + static_cast<limb_t>(p);
+        r[2*i] = static_cast<limb_t>(t);
+        t >>= limb_bits;
+        t += static_cast<dlimb_t>(r[2*i+1]) + static_cast<limb_t>(p >> limb_bits);
+        r[2*i+1] = static_cast<limb_t>(t);
+        t >>= limb_bits;
+    }
+}
+
+void BigInt::sqr_karatsuba(limb_t* r, const limb_t* a, size_t n){
+    // a^2 = z2*B^(2l) + (z2+z0-(a1-a0)^2)*B^l + z0: the middle square needs no carries
+    size_t l = n/2, h = n - l; // h >= l
+    scratch_vector tmp(5*h+1, scratch_resource());
+    limb_t* d = tmp.data();
+    limb_t* z1 = d + h; // 2*h limbs
+    limb_t* m = z1 + 2*h; // 2*h+1 limbs
+    if (cmp(a+l, h, a, l) >= 0){
+        sub(d, a+l, h, a, l);
+    } else { // a1 < a0 < B^l, so a[n-1] == 0 when h > l
+        sub(d, a, l, a+l, l);
+        if (h > l) d[l] = 0;
+    }
+    bool fork = (2*n >= parallel_threshold);
+    fork_join(fork, [&]{sqr(z1, d, h);}, [&]{
+        fork_join(fork, [&]{sqr(r, a, l);}, // z0
+                        [&]{sqr(r+2*l, a+l, h);}); // z2
+    });
+    m[2*h] = add(m, r+2*l, 2*h, r, 2*l);
+    sub(m, m, 2*h+1, z1, 2*h);
+    size_t mn = 2*h+1;
+    while (mn && (m[mn-1] == 0)) --mn; // 2*a0*a1 < B^(n+1)
+    add(r+l, r+l, 2*n-l, m, mn);
+}
+
+void BigInt::sqr_toom3(limb_t* r, const limb_t* a, size_t n){
+    MemoryScope scope(scratch_resource());
+    size_t k = (n+2)/3;
+    BigInt a0 = from_limbs(a, k), a1 = from_limbs(a+k, k), a2 = from_limbs(a+2*k, n-2*k);
+    BigInt pa = a0 + a2;
+    BigInt pa1 = pa + a1;
+    BigInt pam1 = pa - a1;
+    BigInt pam2 = ((pam1 + a2) << 1) - a0;
+
+    const BigInt* x[] = {&a0, &pa1, &pam1, &pam2, &a2};
+    BigInt w[5];
+    mul_batch(w, x, x, 5);
+    toom3_interpolate(r, n, k, w[0], w[1], w[2], w[3], w[4]);
+}
+
+void BigInt::sqr_toom4(limb_t* r, const limb_t* a, size_t n){
+    MemoryScope scope(scratch_resource());
+    size_t k = (n+3)/4;
+    BigInt a0 = from_limbs(a, k), a1 = from_limbs(a+k, k), a2 = from_limbs(a+2*k, k), a3 = from_limbs(a+3*k, n-3*k);
+    BigInt ea = a0 + a2, oa = a1 + a3;
+    BigInt pa1 = ea + oa, pam1 = ea - oa;
+    ea = a0 + (a2 << 2);
+    oa = (a1 << 1) + (a3 << 3);
+    BigInt pa2 = ea + oa, pam2 = ea - oa;
+    BigInt pah = (a0 << 3) + (a1 << 2) + (a2 << 1) + a3;
+
+    const BigInt* x[] = {&a0, &pa1, &pam1, &pa2, &pam2, &pah, &a3};
+    BigInt w[7];
+    mul_batch(w, x, x, 7);
+    toom4_interpolate(r, n, k, w[0], w[1], w[2], w[3], w[4], w[5], w[6]);
+}
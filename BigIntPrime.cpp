@@ -0,0 +1,242 @@
+#include "BigInt.hpp"
+#include "BarrettReducer.hpp"
+#include "MontgomeryContext.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// trial division runs up to here at most, the table holds the odd primes below it
+static const uint64_t trial_limit = 65536;
+
+struct PrimeGroup {
+    // consecutive primes whose product fits a limb: one pass over the number per group
+    BigInt::limb_t product;
+    uint32_t first, last; // [first, last) in the table
+};
+
+const std::vector<uint32_t>& BigInt::small_primes(){
+    static const std::vector<uint32_t> table = []{
+        std::vector<uint32_t> res = BigInt::primes_up_to(trial_limit - 1);
+        res.erase(res.begin()); // 2 is a bit test
+        return res;
+    }();
+    return table;
+}
+
+static const std::vector<PrimeGroup>& prime_groups(const std::vector<uint32_t>& primes){
+    // primes is BigInt::small_primes()
+    static const std::vector<PrimeGroup> table = [&]{
+        std::vector<PrimeGroup> res;
+        for (uint32_t i=0; i<primes.size(); ){
+            PrimeGroup g = {primes[i], i, i+1};
+            while ((g.last < primes.size()) && (g.product <= BigInt::limb_max / primes[g.last]))
+                g.product *= primes[g.last++];
+            res.push_back(g);
+            i = g.last;
+        }
+        return res;
+    }();
+    return table;
+}
+
+static uint64_t trial_bound(size_t bits){
+    // the sieve pays off while a remainder pass is cheap next to an exponentiation
+    return std::min<uint64_t>(trial_limit, std::max<uint64_t>(1024, 16*static_cast<uint64_t>(bits)));
+}
+
+static int jacobi(uint64_t a, uint64_t n){
+    // n odd
+    int res = 1;
+    a %= n;
+    while (a){
+        while (!(a & 1)){
+            a >>= 1;
+            if (((n & 7) == 3) || ((n & 7) == 5)) res = -res;
+        }
+        std::swap(a, n);
+        if (((a & 3) == 3) && ((n & 3) == 3)) res = -res;
+        a %= n;
+    }
+    return ((n == 1) ? res : 0);
+}
+
+static uint64_t splitmix64(uint64_t& state){
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int BigInt::trial_divide(const BigInt& n, uint64_t bound){
+    // n odd and > 2: 0 for composite, 1 for prime (every prime up to sqrt(n) tried), -1 undecided
+    const std::vector<uint32_t>& primes = small_primes();
+    for (const PrimeGroup& g : prime_groups(primes)){
+        if (primes[g.first] > bound) break;
+        limb_t r = divrem_1(nullptr, n.data.data(), n.data.size(), g.product);
+        for (uint32_t i=g.first; i<g.last; ++i){
+            uint64_t p = primes[i];
+            if (r % p) continue;
+            return (((n.data.size() == 1) && (n.data[0] == p)) ? 1 : 0);
+        }
+        uint64_t top = primes[g.last-1];
+        if ((n.bit_size() <= 32) && (top*top > n.bits_at(0))) return 1;
+    }
+    return -1;
+}
+
+bool BigInt::strong_probable_prime(const BigInt& n, const BigInt& base, const MontgomeryContext& ctx){
+    // Miller-Rabin: n-1 = d*2^s, base^d == 1 or base^(d*2^r) == -1 for some r < s
+    BigInt n1 = n - 1;
+    size_t s = 0;
+    while (!(n1.bits_at(s) & 1)) ++s;
+    BigInt x = ctx.powmod(base, n1 >> s);
+    if ((x == 1) || (x == n1)) return true;
+    for (size_t r=1; r<s; ++r){
+        x = ctx.sqrmod(x);
+        if (x == n1) return true;
+        if (x == 1) return false;
+    }
+    return false;
+}
+
+bool BigInt::lucas_probable_prime(const BigInt& n){
+    // extra strong Lucas test with Q = 1 and the first P of 3, 4, 5, ... with (P^2-4 / n) == -1;
+    // n+1 = d*2^s: U_d == 0 and V_d == +-2, or V_(d*2^r) == 0 for some r < s-1.
+    // Only V is run: V_2k = V_k^2 - 2, V_2k+1 = V_k*V_k+1 - P, and U_d == 0 exactly when
+    // 2*V_d+1 == P*V_d (P^2-4 is prime to n)
+    uint64_t p = 3;
+    for (;;){
+        // (dp / n): the twos by n mod 8, the odd part o by reciprocity from (n mod o / o)
+        uint64_t dp = p*p - 4, o = dp, n8 = n.bits_at(0) & 7;
+        int j = 1;
+        for (; !(o & 1); o >>= 1)
+            if ((n8 == 3) || (n8 == 5)) j = -j;
+        if (((o & 3) == 3) && ((n8 & 3) == 3)) j = -j;
+        j *= jacobi(n.mod_native(o), o);
+        if (j == -1) break;
+        if ((j == 0) && (n.cmp_native(dp, false) > 0)) return false;
+        // a square never gives -1
+        if ((p == 20) && (n.isqrt().square() == n)) return false;
+        ++p;
+    }
+    BarrettReducer red(n);
+    auto mul_sub = [&](const BigInt& x, const BigInt& y, uint64_t c){ // x*y - c mod n
+        BigInt res = red.reduce((&x == &y) ? x.square() : x * y);
+        res -= c;
+        if (res < 0) res += n;
+        return res;
+    };
+    BigInt n1 = n + 1;
+    size_t s = 0;
+    while (!(n1.bits_at(s) & 1)) ++s;
+    BigInt d = n1 >> s;
+    BigInt v = 2, v1 = p; // V_0, V_1
+    for (size_t i=d.bit_size(); i--; ){
+        if (d.bits_at(i) & 1){
+            v = mul_sub(v, v1, p);
+            v1 = mul_sub(v1, v1, 2);
+        } else {
+            v1 = mul_sub(v, v1, p);
+            v = mul_sub(v, v, 2);
+        }
+    }
+    BigInt lhs = v1 << 1, rhs = v * p;
+    if ((lhs % n == rhs % n) && ((v == 2) || (v == n - 2))) return true;
+    for (size_t r=0; r+1<s; ++r){
+        if (v.data.empty()) return true;
+        v = mul_sub(v, v, 2);
+    }
+    return false;
+}
+
+bool BigInt::prime_test(const BigInt& n, int rounds, bool trial){
+    // n > 0; trial is false when n has been sieved by every prime trial_divide would try
+    BIGINT_STATS_SCOPE(prime_test, n.data.size());
+    if ((n.data.size() == 1) && (n.data[0] < 4)) return (n.data[0] > 1);
+    if (!(n.data[0] & 1)) return false;
+    if (trial){
+        int res = trial_divide(n, trial_bound(n.bit_size()));
+        if (res >= 0) return (res == 1);
+    }
+    MontgomeryContext ctx(n);
+    if (!strong_probable_prime(n, BigInt(2), ctx)) return false;
+    if (!lucas_probable_prime(n)) return false;
+    // extra bases in [3, n-2], drawn from n itself so a result is reproducible
+    uint64_t state = n.bits_at(0) ^ (static_cast<uint64_t>(n.bit_size()) << 32);
+    BigInt span = n - 4;
+    for (int i=0; i<rounds; ++i){
+        BigInt base = splitmix64(state);
+        base.mul_native(splitmix64(state), false);
+        base = base % span + 3;
+        if (!strong_probable_prime(n, base, ctx)) return false;
+    }
+    return true;
+}
+
+void BigInt::prime_test_tree(const BigInt* const* v, char* res, size_t n, int rounds, ThreadPool* pool){
+    // one test costs an exponentiation: a few limbs' worth already outweighs a fork
+    if (pool && (n > 1) && (total_limbs(v, n) >= 16)){
+        size_t h = n/2;
+        pool->invoke([&]{prime_test_tree(v, res, h, rounds, pool);},
+                     [&]{prime_test_tree(v+h, res+h, n-h, rounds, pool);});
+        return;
+    }
+    for (size_t i=0; i<n; ++i) res[i] = (!v[i]->neg && !v[i]->data.empty() && prime_test(*v[i], rounds, true));
+}
+
+bool BigInt::is_probable_prime(int rounds) const {
+    if (neg || data.empty()) return false;
+    return prime_test(*this, rounds, true);
+}
+
+std::vector<bool> BigInt::are_probable_primes(const std::vector<BigInt>& candidates, int rounds){
+    std::vector<const BigInt*> v;
+    for (const BigInt& x : candidates) v.push_back(&x);
+    std::unique_ptr<char[]> res(new char[v.size()]); // one byte each, written by different threads
+    prime_test_tree(v.data(), res.get(), v.size(), rounds, thread_pool());
+    return std::vector<bool>(res.get(), res.get() + v.size());
+}
+
+BigInt BigInt::next_prime(int rounds) const {
+    if (*this < 2) return BigInt(2);
+    BigInt c = *this + 1;
+    if (c.bit_size() <= 32){
+        // short enough to be one of the sieving primes: no sieve
+        if (c == 2) return c;
+        if (!(c.data[0] & 1)) ++c;
+        while (!prime_test(c, rounds, true)) c += 2;
+        return c;
+    }
+    if (!(c.data[0] & 1)) ++c;
+    // sieve windows of odd candidates c + 2i by the residues of c, only the survivors are tested
+    const std::vector<uint32_t>& primes = small_primes();
+    size_t count = 0;
+    uint64_t bound = trial_bound(c.bit_size());
+    while ((count < primes.size()) && (primes[count] <= bound)) ++count;
+    std::vector<uint32_t> res(count);
+    for (const PrimeGroup& g : prime_groups(primes)){
+        if (g.first >= count) break;
+        limb_t r = divrem_1(nullptr, c.data.data(), c.data.size(), g.product);
+        for (uint32_t i=g.first; (i<g.last) && (i<count); ++i) res[i] = static_cast<uint32_t>(r % primes[i]);
+    }
+    size_t window = std::max<size_t>(256, 4*c.bit_size());
+    std::vector<char> composite(window);
+    for (;;){
+        std::fill(composite.begin(), composite.end(), 0);
+        for (size_t i=0; i<count; ++i){
+            // c + 2j == 0 mod p from j = (p - r) / 2 mod p on
+            uint64_t p = primes[i], j = (p - res[i]) % p;
+            if (j & 1) j += p;
+            for (j/=2; j<window; j+=p) composite[j] = 1;
+        }
+        for (size_t j=0; j<window; ++j){
+            if (composite[j]) continue;
+            BigInt x = c + 2*static_cast<uint64_t>(j);
+            if (prime_test(x, rounds, false)) return x;
+        }
+        c += 2*static_cast<uint64_t>(window);
+        for (size_t i=0; i<count; ++i) res[i] = static_cast<uint32_t>((res[i] + 2*window) % primes[i]);
+    }
+}
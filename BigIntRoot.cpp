@@ -0,0 +1,210 @@
+#include "BigInt.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// roots up to this many bits come out of a double to within a unit
+static const size_t root_estimate_bits = 45;
+
+static BigInt power(const BigInt& x, uint64_t e){
+    // left-to-right binary powering
+    if (e == 0) return BigInt(1);
+    int top = 63;
+    while (!((e >> top) & 1)) --top;
+    BigInt res = x;
+    for (int i=top-1; i>=0; --i){
+        res = res.square();
+        if ((e >> i) & 1) res *= x;
+    }
+    return res;
+}
+
+static double root_estimate(size_t bits, double mant, uint64_t k){
+    // 2^((bits-1 + log2(mant)) / k), the integer part of the exponent is kept exact
+    uint64_t a = (bits-1) / k, rest = (bits-1) % k;
+    return std::ldexp(std::exp2((static_cast<double>(rest) + std::log2(mant)) / k), static_cast<int>(a));
+}
+
+static uint64_t pow_mod_small(uint64_t b, uint64_t e, uint64_t q){
+    // q < 2^32
+    uint64_t res = 1;
+    b %= q;
+    for (; e; e >>= 1){
+        if (e & 1) res = res * b % q;
+        b = b * b % q;
+    }
+    return res;
+}
+
+static bool is_small_prime(uint64_t q){
+    if (q < 2) return false;
+    for (uint64_t d=2; d*d<=q; ++d)
+        if (q % d == 0) return false;
+    return true;
+}
+
+uint64_t BigInt::bits_at(size_t shift) const {
+    uint64_t res = 0;
+    for (size_t i=shift/limb_bits; i<data.size(); ++i){
+        // bit 0 of limb i lands at pos
+        long long pos = static_cast<long long>(i*limb_bits) - static_cast<long long>(shift);
+        if (pos >= 64) break;
+        res |= ((pos >= 0) ? (static_cast<uint64_t>(data[i]) << pos) : (static_cast<uint64_t>(data[i]) >> -pos));
+    }
+    return res;
+}
+
+double BigInt::mantissa() const {
+    // the top limbs hold more bits than a double
+    size_t n = data.size(), used = std::min<size_t>(n, 128/limb_bits + 1);
+    double x = 0;
+    for (size_t i=0; i<used; ++i)
+        x = std::ldexp(x, limb_bits) + static_cast<double>(data[n-1-i]);
+    size_t drop = (bit_size()-1) - limb_bits*(n-used); // fewer than the bits used
+    return std::ldexp(x, -static_cast<int>(drop));
+}
+
+BigInt BigInt::root_floor(const BigInt& m, uint64_t k, BigInt& pw){
+    size_t bits = m.bit_size();
+    size_t b = bits / k; // the root has b or b+1 bits
+    if (b <= root_estimate_bits){
+        BigInt r(static_cast<uint64_t>(root_estimate(bits, m.mantissa(), k)));
+        pw = power(r, k);
+        while (pw > m){
+            --r;
+            pw = power(r, k);
+        }
+        for (;;){
+            BigInt r1 = r + 1;
+            if (r1.bit_size() > b + 1) break; // past the root, and power() would outgrow m
+            BigInt p1 = power(r1, k);
+            if (p1 > m) break;
+            r = std::move(r1);
+            pw = std::move(p1);
+        }
+        return r;
+    }
+    // x, the root of the top bits shifted back, is below the root by less than 2^(s+1),
+    // one Newton step leaves an error below (k-1) * 2^(2s+2) / 2^(b-1) < 1 from above
+    size_t kb = 0;
+    for (uint64_t t=k; t; t>>=1) ++kb;
+    size_t s = ((b > kb + 5) ? (b - kb - 3)/2 : 1);
+    BigInt t;
+    BigInt x = root_floor(m >> (k*s), k, t) << s;
+    BigInt y = x * (k-1) + m / power(x, k-1);
+    y /= k; // y >= floor(m^(1/k)) for every x > 0 (AM-GM)
+    pw = power(y, k);
+    while (pw > m){
+        --y;
+        pw = power(y, k);
+    }
+    return y;
+}
+
+bool BigInt::root_exact(const BigInt& m, uint64_t k, uint64_t twos, BigInt& root){
+    if (twos % k) return false;
+    size_t bits = m.bit_size();
+    if (bits / k <= root_estimate_bits){
+        // the estimate is the whole root: its k-th power has to match the low 64 bits first
+        uint64_t c = static_cast<uint64_t>(std::llround(root_estimate(bits, m.mantissa(), k)));
+        uint64_t low = m.bits_at(0);
+        for (uint64_t d=((c > 2) ? c-1 : 2); d<=c+1; ++d){
+            uint64_t p = 1, b = d;
+            for (uint64_t e=k; e; e >>= 1){ // modulo 2^64
+                if (e & 1) p *= b;
+                b *= b;
+            }
+            if (p != low) continue;
+            BigInt r(d);
+            if (power(r, k) == m){
+                root = std::move(r);
+                return true;
+            }
+        }
+        return false;
+    }
+    // a k-th power is 0 or a k-th power residue modulo every prime q = 1 (mod k)
+    int tests = 0;
+    for (uint64_t q=2*k+1; tests<6; q+=2*k){
+        if (!is_small_prime(q)) continue;
+        ++tests;
+        uint64_t t = m.mod_native(q);
+        if (t && (pow_mod_small(t, (q-1)/k, q) != 1)) return false;
+    }
+    BigInt pw;
+    BigInt r = root_floor(m, k, pw);
+    if (pw != m) return false;
+    root = std::move(r);
+    return true;
+}
+
+BigInt BigInt::isqrt() const {
+    BigInt rem;
+    return iroot(2, rem);
+}
+BigInt BigInt::isqrt(BigInt& remain) const {return iroot(2, remain);}
+BigInt BigInt::iroot(uint64_t k) const {
+    BigInt rem;
+    return iroot(k, rem);
+}
+BigInt BigInt::iroot(uint64_t k, BigInt& remain) const {
+    // remain may be *this
+    BIGINT_STATS_SCOPE(root, data.size());
+    if (k == 0) throw std::invalid_argument("zeroth root");
+    if (neg && !(k & 1)) throw std::invalid_argument("even root of a negative number");
+    BigInt m = abs(), pw, r;
+    if (data.empty() || (k == 1)){
+        r = m;
+        pw = m;
+    } else if (k >= m.bit_size()){ // 2^k > m
+        r = 1;
+        pw = 1;
+    } else {
+        r = root_floor(m, k, pw);
+    }
+    BigInt rem = m - pw;
+    if (neg){
+        r = -std::move(r);
+        rem = -std::move(rem);
+    }
+    remain = std::move(rem);
+    return r;
+}
+
+bool BigInt::is_perfect_power() const {
+    BigInt root;
+    uint64_t k;
+    return is_perfect_power(root, k);
+}
+bool BigInt::is_perfect_power(BigInt& root, uint64_t& k) const {
+    // prime exponents one at a time: once m = s^p, s is tested again from p on
+    // (a smaller prime exponent of s would have been one of m already)
+    BigInt m = abs();
+    if (m.data.empty() || ((m.data.size() == 1) && (m.data[0] == 1))){
+        root = *this;
+        k = (neg ? 3 : 2);
+        return true;
+    }
+    size_t z = 0;
+    while (m.data[z] == 0) ++z;
+    uint64_t twos = z*limb_bits;
+    for (limb_t w=m.data[z]; !(w & 1); w >>= 1) ++twos;
+    std::vector<uint32_t> primes = primes_up_to(m.bit_size());
+    uint64_t e = 1;
+    BigInt s;
+    for (size_t i=(neg ? 1 : 0); (i < primes.size()) && (primes[i] <= m.bit_size()); ){
+        if (root_exact(m, primes[i], twos, s)){
+            m = std::move(s);
+            e *= primes[i];
+            twos /= primes[i];
+        } else {
+            ++i;
+        }
+    }
+    if (e == 1) return false;
+    root = (neg ? -m : m);
+    k = e;
+    return true;
+}
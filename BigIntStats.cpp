@@ -0,0 +1,145 @@
+#include "BigInt.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+const char* BigInt::Stats::name(Operation op){
+    static const char* const names[] = {"mul", "sqr", "div", "from_string", "to_string", "gcd", "powmod", "root", "prime_test"};
+    return names[static_cast<size_t>(op)];
+}
+
+#ifdef BIGINT_STATS
+
+namespace {
+
+// the counters as one flat array: per operation calls, nanoseconds, allocations, bytes and
+// the size classes, then the allocations, reallocations and bytes of all limb buffers
+constexpr size_t op_count = static_cast<size_t>(BigInt::Operation::count);
+constexpr size_t op_fields = 4 + BigInt::size_classes;
+constexpr size_t total_allocations = op_count * op_fields;
+constexpr size_t total_reallocations = total_allocations + 1;
+constexpr size_t total_bytes = total_allocations + 2;
+constexpr size_t field_count = total_allocations + 3;
+
+struct Block {
+    // written by its own thread only, read by stats() from any thread
+    std::atomic<uint64_t> v[field_count];
+    Block(){
+        for (std::atomic<uint64_t>& x : v) x.store(0, std::memory_order_relaxed);
+    }
+    uint64_t get(size_t i) const {return v[i].load(std::memory_order_relaxed);}
+    void add(size_t i, uint64_t x){v[i].store(get(i) + x, std::memory_order_relaxed);}
+};
+
+struct Registry {
+    std::mutex lock;
+    std::vector<const Block*> running;
+    std::vector<uint64_t> finished = std::vector<uint64_t>(field_count); // blocks of threads that ended
+    std::vector<uint64_t> base = std::vector<uint64_t>(field_count); // the sums at the last reset_stats()
+};
+Registry& registry(){
+    static Registry* reg = new Registry; // never destroyed: threads may end after static destruction
+    return *reg;
+}
+
+struct ThreadBlock : Block {
+    ThreadBlock(){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        reg.running.push_back(this);
+    }
+    ~ThreadBlock(){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        for (size_t i=0; i<field_count; ++i) reg.finished[i] += get(i);
+        reg.running.erase(std::find(reg.running.begin(), reg.running.end(), this));
+    }
+};
+Block& counters(){
+    static thread_local ThreadBlock block;
+    return block;
+}
+
+// all blocks added up, the registry locked
+std::vector<uint64_t> sums(const Registry& reg){
+    std::vector<uint64_t> res = reg.finished;
+    for (const Block* b : reg.running)
+        for (size_t i=0; i<field_count; ++i) res[i] += b->get(i);
+    return res;
+}
+
+uint64_t now(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+void small_vector_allocated(size_t bytes, bool moved){
+    Block& b = counters();
+    b.add(total_allocations, 1);
+    if (moved) b.add(total_reallocations, 1);
+    b.add(total_bytes, bytes);
+}
+
+BigInt::StatsScope::StatsScope(Operation op, size_t limbs)
+: op(op), limbs(limbs), result(nullptr) {
+    Block& b = counters();
+    allocations = b.get(total_allocations);
+    bytes = b.get(total_bytes);
+    start = now();
+}
+BigInt::StatsScope::StatsScope(Operation op, const BigInt* result)
+: StatsScope(op, static_cast<size_t>(0)) {
+    this->result = result;
+}
+BigInt::StatsScope::~StatsScope(){
+    uint64_t t = now();
+    Block& b = counters();
+    if (result) limbs = result->data.size();
+    size_t size_class = 0;
+    for (size_t n=limbs; n; n >>= 1) ++size_class;
+    size_t f = static_cast<size_t>(op) * op_fields;
+    b.add(f, 1);
+    b.add(f+1, t - start);
+    b.add(f+2, b.get(total_allocations) - allocations);
+    b.add(f+3, b.get(total_bytes) - bytes);
+    b.add(f+4 + std::min(size_class, size_classes-1), 1);
+}
+
+BigInt::Stats BigInt::stats(){
+    Registry& reg = registry();
+    std::vector<uint64_t> v;
+    {
+        std::lock_guard<std::mutex> guard(reg.lock);
+        v = sums(reg);
+        for (size_t i=0; i<field_count; ++i) v[i] -= reg.base[i];
+    }
+    Stats res;
+    for (size_t op=0; op<op_count; ++op){
+        const uint64_t* f = &v[op * op_fields];
+        OperationStats& s = res.ops[op];
+        s.calls = f[0];
+        s.nanoseconds = f[1];
+        s.allocations = f[2];
+        s.bytes_allocated = f[3];
+        std::copy(f+4, f+op_fields, s.sizes);
+    }
+    res.allocations = v[total_allocations];
+    res.reallocations = v[total_reallocations];
+    res.bytes_allocated = v[total_bytes];
+    return res;
+}
+void BigInt::reset_stats(){
+    // the counters only grow, so a reset moves the base instead of clearing other threads' blocks
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    reg.base = sums(reg);
+}
+
+#else
+
+BigInt::Stats BigInt::stats(){return Stats();}
+void BigInt::reset_stats(){}
+
+#endif
@@ -0,0 +1,129 @@
+#include "MontgomeryContext.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+MontgomeryContext::MontgomeryContext(const BigInt& modulus) : m(modulus), n(modulus.data.size()){
+    if (m.neg || m.data.empty() || !(m.data[0] & 1))
+        throw std::invalid_argument("Montgomery modulus must be odd and positive");
+    limb_t m0 = m.data[0], inv = m0; // m0*m0 == 1 mod 8: three correct bits
+    for (int i=0; i<5; ++i)
+        inv *= 2 - m0*inv; // every Newton step doubles them
+    minv = 0 - inv;
+    BigInt t = 1;
+    t <<= 2 * n * BigInt::limb_bits;
+    t %= m;
+    r2.assign(n, 0);
+    std::copy(t.data.begin(), t.data.end(), r2.begin());
+}
+
+const BigInt& MontgomeryContext::modulus() const {return m;}
+
+void MontgomeryContext::load(limb_t* r, const BigInt& x) const {
+    const BigInt* p = &x;
+    BigInt t;
+    if (x.neg || (BigInt::cmp(x.data.data(), x.data.size(), m.data.data(), n) >= 0)){
+        t = x % m;
+        if (t.neg) t += m;
+        p = &t;
+    }
+    std::fill(std::copy(p->data.begin(), p->data.end(), r), r+n, 0);
+}
+
+void MontgomeryContext::redc(limb_t* r, limb_t* t) const {
+    const limb_t* mp = m.data.data();
+    for (size_t i=0; i<n; ++i){
+        limb_t q = t[i] * minv;
+        // t[i] is zero now and keeps the carry out of t[i+n-1] instead
+        t[i] = BigInt::addmul_1(t+i, mp, n, q);
+    }
+    limb_t c = BigInt::add(r, t+n, n, t, n); // below 2*m
+    if (c || (BigInt::cmp(r, n, mp, n) >= 0))
+        BigInt::sub(r, r, n, mp, n);
+}
+
+void MontgomeryContext::mul_redc(limb_t* r, const limb_t* a, const limb_t* b, limb_t* t) const {
+    BigInt::mul(t, a, n, b, n); // a == b goes to the squaring path
+    redc(r, t);
+}
+
+BigInt MontgomeryContext::mulmod(const BigInt& a, const BigInt& b) const {
+    // a*b/R, then times R^2/R
+    BigInt::scratch_vector buf(4*n, BigInt::scratch_resource());
+    limb_t* x = buf.data();
+    limb_t* y = x + n;
+    limb_t* t = y + n;
+    load(x, a);
+    load(y, b);
+    mul_redc(x, x, y, t);
+    mul_redc(x, x, r2.data(), t);
+    return BigInt::from_limbs(x, n);
+}
+
+BigInt MontgomeryContext::sqrmod(const BigInt& a) const {
+    BigInt::scratch_vector buf(3*n, BigInt::scratch_resource());
+    limb_t* x = buf.data();
+    limb_t* t = x + n;
+    load(x, a);
+    mul_redc(x, x, x, t);
+    mul_redc(x, x, r2.data(), t);
+    return BigInt::from_limbs(x, n);
+}
+
+BigInt MontgomeryContext::powmod(const BigInt& base, const BigInt& exp) const {
+    BIGINT_STATS_SCOPE(powmod, n);
+    if (exp.neg)
+        throw std::invalid_argument("negative exponent in powmod");
+    size_t bits = exp.bit_size();
+    if (bits == 0)
+        return BigInt(1) % m;
+
+    // the window grows with the exponent, odd powers g, g^3, ..., g^(2^w-1) are tabulated;
+    // all the buffers are taken here, the loop below only works in them
+    unsigned w = 1;
+    for (size_t t : {7, 25, 81, 241, 673, 1793})
+        if (bits > t) ++w;
+    size_t tn = static_cast<size_t>(1) << (w-1);
+    BigInt::scratch_vector buf((tn+3) * n, BigInt::scratch_resource());
+    limb_t* table = buf.data();
+    limb_t* acc = table + tn*n;
+    limb_t* t = acc + n; // 2*n limbs
+    load(acc, base);
+    mul_redc(table, acc, r2.data(), t); // g*R
+    if (tn > 1){
+        mul_redc(acc, table, table, t); // g^2*R
+        for (size_t i=1; i<tn; ++i)
+            mul_redc(table + i*n, table + (i-1)*n, acc, t);
+    }
+
+    auto bit = [&](size_t i) -> limb_t {
+        return (exp.data[i / BigInt::limb_bits] >> (i % BigInt::limb_bits)) & 1;
+    };
+    // left to right; the top bit is set, so the first window loads acc
+    bool first = true;
+    size_t i = bits;
+    while (i){
+        if (!bit(i-1)){
+            mul_redc(acc, acc, acc, t);
+            --i;
+            continue;
+        }
+        size_t j = (i > w) ? i-w : 0; // the window is bits [j, i), it ends with a set bit
+        while (!bit(j)) ++j;
+        size_t val = 0;
+        for (size_t k=i; k>j; --k)
+            val = (val << 1) | bit(k-1);
+        const limb_t* g = table + (val >> 1) * n;
+        if (first){
+            std::copy(g, g+n, acc);
+            first = false;
+        } else {
+            for (size_t k=j; k<i; ++k)
+                mul_redc(acc, acc, acc, t);
+            mul_redc(acc, acc, g, t);
+        }
+        i = j;
+    }
+    std::fill(std::copy(acc, acc+n, t), t+2*n, 0);
+    redc(acc, t);
+    return BigInt::from_limbs(acc, n);
+}
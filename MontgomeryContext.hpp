@@ -0,0 +1,28 @@
+#ifndef MontgomeryContext_HPP
+#define MontgomeryContext_HPP
+
+#include <vector>
+#include "BigInt.hpp"
+
+// modular arithmetic for one odd modulus m through Montgomery's representation x*R mod m, R = B^n;
+// operands and results are ordinary values, negative ones and ones past m are reduced first
+class MontgomeryContext{
+    typedef BigInt::limb_t limb_t;
+    BigInt m;
+    size_t n; // limbs of m
+    limb_t minv; // -m^-1 mod B
+    std::vector<limb_t> r2; // R^2 mod m, n limbs
+
+    void load(limb_t* r, const BigInt& x) const; // x mod m padded to n limbs
+    void redc(limb_t* r, limb_t* t) const; // r = t/R mod m for t < m*R (2*n limbs), t is destroyed
+    void mul_redc(limb_t* r, const limb_t* a, const limb_t* b, limb_t* t) const; // r = a*b/R mod m, t holds 2*n limbs
+public:
+    explicit MontgomeryContext(const BigInt& modulus);
+
+    const BigInt& modulus() const;
+    BigInt mulmod(const BigInt& a, const BigInt& b) const;
+    BigInt sqrmod(const BigInt& a) const;
+    BigInt powmod(const BigInt& base, const BigInt& exp) const; // sliding window, exp >= 0
+};
+
+#endif // MontgomeryContext_HPP
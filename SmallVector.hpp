@@ -0,0 +1,157 @@
+#ifndef SmallVector_HPP
+#define SmallVector_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <initializer_list>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+// resource that SmallVectors created on this thread allocate from, nullptr for the global heap
+inline std::pmr::memory_resource*& small_vector_resource(){
+    static thread_local std::pmr::memory_resource* res = nullptr;
+    return res;
+}
+
+#ifdef BIGINT_STATS
+void small_vector_allocated(size_t bytes, bool moved); // counted by BigInt::stats() (BigIntStats.cpp)
+#endif
+
+// vector of trivially copyable values which keeps up to N of them inline
+// and goes to the heap only past that; the subset of std::vector used by BigInt.
+// Like the std::pmr containers it keeps its resource for life: a copy takes the
+// thread's current one, a move takes the source's, a move assignment between
+// different resources copies
+template <typename T, size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector holds trivially copyable values only");
+    T* ptr;
+    size_t sz = 0;
+    size_t cap = N;
+    std::pmr::memory_resource* mr;
+    T buf[N];
+
+    bool is_inline() const {return ptr == buf;}
+    T* allocate(size_t n){
+        if (mr) return static_cast<T*>(mr->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(){
+        if (is_inline()) return;
+        if (mr)
+            mr->deallocate(ptr, cap * sizeof(T), alignof(T));
+        else
+            ::operator delete(ptr);
+    }
+    void grow(size_t new_cap){
+        // new_cap > cap
+#ifdef BIGINT_STATS
+        small_vector_allocated(new_cap * sizeof(T), sz != 0);
+#endif
+        T* p = allocate(new_cap);
+        if (sz) std::memcpy(p, ptr, sz * sizeof(T));
+        deallocate();
+        ptr = p;
+        cap = new_cap;
+    }
+    void steal(SmallVector& other){
+        // *this has no heap buffer, a heap buffer of other comes from mr
+        if (other.is_inline()){
+            ptr = buf;
+            cap = N;
+            if (other.sz) std::memcpy(buf, other.buf, other.sz * sizeof(T));
+        } else {
+            ptr = other.ptr;
+            cap = other.cap;
+            other.ptr = other.buf;
+            other.cap = N;
+        }
+        sz = other.sz;
+        other.sz = 0;
+    }
+public:
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    SmallVector() : ptr(buf), mr(small_vector_resource()) {}
+    explicit SmallVector(std::pmr::memory_resource* res) : ptr(buf), mr(res) {}
+    explicit SmallVector(size_t n, T val = T()) : ptr(buf), mr(small_vector_resource()) {assign(n, val);}
+    SmallVector(std::initializer_list<T> il) : ptr(buf), mr(small_vector_resource()) {assign(il.begin(), il.end());}
+    SmallVector(const SmallVector& other) : ptr(buf), mr(small_vector_resource()) {assign(other.begin(), other.end());}
+    SmallVector(SmallVector&& other) noexcept : ptr(buf), mr(other.mr) {steal(other);}
+    ~SmallVector(){
+        deallocate();
+    }
+
+    SmallVector& operator=(const SmallVector& other){
+        if (this != &other) assign(other.begin(), other.end());
+        return *this;
+    }
+    SmallVector& operator=(SmallVector&& other){
+        if (this == &other) return *this;
+        if ((mr == other.mr) || other.is_inline()){
+            deallocate();
+            steal(other);
+        } else { // the buffer can't change hands between resources
+            assign(other.begin(), other.end());
+            other.sz = 0;
+        }
+        return *this;
+    }
+    SmallVector& operator=(std::initializer_list<T> il){
+        assign(il.begin(), il.end());
+        return *this;
+    }
+
+    void assign(const T* first, const T* last){
+        size_t n = last - first;
+        sz = 0;
+        if (n > cap) grow(n);
+        if (n) std::memmove(ptr, first, n * sizeof(T));
+        sz = n;
+    }
+    void assign(size_t n, T val){
+        sz = 0;
+        resize(n, val);
+    }
+
+    size_t size() const {return sz;}
+    size_t capacity() const {return cap;}
+    std::pmr::memory_resource* resource() const {return mr;}
+    bool empty() const {return sz == 0;}
+    T* data() {return ptr;}
+    const T* data() const {return ptr;}
+    T& operator[](size_t i) {return ptr[i];}
+    const T& operator[](size_t i) const {return ptr[i];}
+    T& back() {return ptr[sz-1];}
+    const T& back() const {return ptr[sz-1];}
+    iterator begin() {return ptr;}
+    iterator end() {return ptr+sz;}
+    const_iterator begin() const {return ptr;}
+    const_iterator end() const {return ptr+sz;}
+
+    void reserve(size_t n){
+        if (n > cap) grow(n);
+    }
+    void resize(size_t n, T val = T()){
+        if (n > cap) grow(((2*cap > n) ? 2*cap : n));
+        for (size_t i=sz; i<n; ++i) ptr[i] = val;
+        sz = n;
+    }
+    void push_back(T val){
+        if (sz == cap) grow(2*cap);
+        ptr[sz++] = val;
+    }
+    void pop_back() {--sz;}
+    void clear() {sz = 0;}
+    void swap(SmallVector& other){
+        SmallVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+};
+
+#endif // SmallVector_HPP
@@ -0,0 +1,121 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+// pool and queue the current thread works for, if any
+static thread_local const ThreadPool* current_pool = nullptr;
+static thread_local size_t current_queue = 0;
+
+ThreadPool::ThreadPool(size_t threads){
+    size_t n = std::max<size_t>(threads, 1);
+    for (size_t i=0; i<n; ++i)
+        queues.emplace_back(new Queue);
+    for (size_t i=1; i<n; ++i)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(idle_m);
+        stop = true;
+    }
+    idle_cv.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+size_t ThreadPool::size() const {return queues.size();}
+
+size_t ThreadPool::queue_index() const {
+    return ((current_pool == this) ? current_queue : 0);
+}
+
+void ThreadPool::push(size_t i, Task* t){
+    {
+        std::lock_guard<std::mutex> lock(queues[i]->m);
+        queues[i]->tasks.push_back(t);
+    }
+    {
+        std::lock_guard<std::mutex> lock(idle_m);
+        ++queued;
+    }
+    idle_cv.notify_one();
+}
+
+bool ThreadPool::take_back(size_t i, Task* t){
+    // usually the newest task; queue 0 is shared, so other threads may have pushed after it
+    std::lock_guard<std::mutex> lock(queues[i]->m);
+    std::deque<Task*>& q = queues[i]->tasks;
+    auto it = std::find(q.rbegin(), q.rend(), t);
+    if (it == q.rend()) return false;
+    q.erase(std::next(it).base());
+    --queued;
+    return true;
+}
+
+ThreadPool::Task* ThreadPool::find(size_t i){
+    if (queued.load() == 0) return nullptr;
+    size_t n = queues.size();
+    for (size_t k=0; k<n; ++k){
+        Queue& q = *queues[(i+k) % n];
+        std::lock_guard<std::mutex> lock(q.m);
+        if (q.tasks.empty()) continue;
+        Task* t;
+        if (k == 0){ // own queue: newest first, its data is still warm
+            t = q.tasks.back();
+            q.tasks.pop_back();
+        } else { // steal the oldest, usually the biggest piece of work
+            t = q.tasks.front();
+            q.tasks.pop_front();
+        }
+        --queued;
+        return t;
+    }
+    return nullptr;
+}
+
+void ThreadPool::run(Task* t){
+    try {
+        t->fn();
+    } catch (...) {
+        t->error = std::current_exception();
+    }
+    t->done.store(true, std::memory_order_release); // the forking thread may drop t from here on
+}
+
+void ThreadPool::work(size_t i){
+    current_pool = this;
+    current_queue = i;
+    for (;;){
+        if (Task* t = find(i)){
+            run(t);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_m);
+        idle_cv.wait(lock, [this]{return stop || (queued.load() > 0);});
+        if (stop) return;
+    }
+}
+
+void ThreadPool::invoke(const std::function<void()>& f, std::function<void()> g){
+    Task t;
+    t.fn = std::move(g);
+    size_t i = queue_index();
+    push(i, &t);
+    std::exception_ptr error;
+    try {
+        f();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (take_back(i, &t)){ // nobody took g: run it here
+        run(&t);
+    } else {
+        while (!t.done.load(std::memory_order_acquire)){
+            if (Task* other = find(i))
+                run(other);
+            else
+                std::this_thread::yield();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+    if (t.error) std::rethrow_exception(t.error);
+}
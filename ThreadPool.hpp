@@ -0,0 +1,52 @@
+#ifndef ThreadPool_HPP
+#define ThreadPool_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fork-join pool with work stealing: every worker keeps a deque of forked tasks, runs its
+// newest one first and steals the oldest one of another deque when it runs dry.
+// A thread waiting for a forked task runs other tasks meanwhile, so nested forks can't deadlock
+class ThreadPool{
+    struct Task {
+        std::function<void()> fn;
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+    };
+    struct Queue {
+        std::mutex m;
+        std::deque<Task*> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues; // queues[0] is shared by the threads outside the pool
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::mutex idle_m;
+    std::condition_variable idle_cv;
+    bool stop = false;
+
+    size_t queue_index() const;
+    void push(size_t i, Task* t);
+    bool take_back(size_t i, Task* t); // t is still queued: remove it
+    Task* find(size_t i); // newest task of queue i, or the oldest one of another queue
+    static void run(Task* t);
+    void work(size_t i);
+public:
+    explicit ThreadPool(size_t threads); // threads-1 workers, the forking thread is the last one
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const;
+    // runs f here and g wherever a thread is free, returns when both are done;
+    // an exception of either is rethrown
+    void invoke(const std::function<void()>& f, std::function<void()> g);
+};
+
+#endif // ThreadPool_HPP
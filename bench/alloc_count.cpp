@@ -0,0 +1,18 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// every heap allocation of the benchmark is counted; kept in a file of its own, so no
+// new-expression is inlined next to the free() below
+static std::atomic<size_t> allocations{0};
+
+size_t allocation_count(){return allocations;}
+
+void* operator new(size_t n){
+    ++allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, size_t) noexcept {std::free(p);}
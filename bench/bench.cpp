@@ -0,0 +1,251 @@
+// throughput of the arithmetic and conversion operations over operand sizes from one limb
+// to millions of bits, written as JSON or CSV so runs can be compared across releases
+//
+//   bigint_bench [--min-bits N] [--max-bits N] [--min-time SECONDS] [--ops a,b,...]
+//                [--threads N] [--format json|csv] [--output FILE]
+
+#include "BigInt.hpp"
+#include "MontgomeryContext.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+size_t allocation_count(); // heap allocations so far (alloc_count.cpp)
+
+#ifndef __VERSION__
+#define __VERSION__ "unknown"
+#endif
+
+namespace {
+
+std::mt19937_64 rng(1);
+size_t sink = 0; // results are folded in here, so no operation is optimized away
+
+BigInt random_bigint(size_t bits){
+    // hex digits go through the linear-time power-of-two path
+    static const char digits[] = "0123456789abcdef";
+    std::string s(1, digits[8 | (rng() & 7)]);
+    for (size_t i=4; i<bits; i+=4) s += digits[rng() & 15];
+    BigInt x(s, 16);
+    return x >> (4*s.size() - bits);
+}
+
+// prepare() builds the operands of one size and returns the timed body
+struct Op {
+    const char* name;
+    size_t max_bits; // slower-growing operations stop earlier
+    std::function<std::function<void()>(size_t bits)> prepare;
+};
+
+std::vector<Op> all_ops(){
+    typedef std::function<void()> body;
+    const size_t any = SIZE_MAX;
+    return {
+        {"add", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), b = random_bigint(bits), r;
+            return [=]() mutable {r = a + b; sink += r.bit_size();};
+        }},
+        {"sub", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), b = random_bigint(bits), r;
+            return [=]() mutable {r = a - b; sink += r.bit_size();};
+        }},
+        {"add_native", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits);
+            return [=]() mutable {a += static_cast<uint64_t>(0x123456789abcdef); sink += a.bit_size();};
+        }},
+        {"mul", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), b = random_bigint(bits), r;
+            return [=]() mutable {r = a; r *= b; sink += r.bit_size();};
+        }},
+        {"mul_unbalanced", any, [](size_t bits) -> body {
+            // a tenth of the size on one side
+            BigInt a = random_bigint(bits), b = random_bigint(bits/10 + 1), r;
+            return [=]() mutable {r = a * b; sink += r.bit_size();};
+        }},
+        {"sqr", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), r;
+            return [=]() mutable {r = a.square(); sink += r.bit_size();};
+        }},
+        {"mul_native", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), r;
+            return [=]() mutable {r = a * static_cast<uint64_t>(0xfedcba987654321); sink += r.bit_size();};
+        }},
+        {"div", any, [](size_t bits) -> body {
+            // 2n bits by n bits
+            BigInt a = random_bigint(2*bits), b = random_bigint(bits), q, r;
+            return [=]() mutable {q = a; q.div(b, r); sink += q.bit_size() + r.bit_size();};
+        }},
+        {"div_native", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), q;
+            return [=]() mutable {q = a; q /= 1000000007u; sink += q.bit_size();};
+        }},
+        {"mod_native", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits);
+            return [=]() mutable {sink += static_cast<size_t>((a % 1000000007u).bit_size());};
+        }},
+        {"shift", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), r;
+            return [=]() mutable {r = (a << 77) >> 13; sink += r.bit_size();};
+        }},
+        {"to_string_10", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits);
+            return [=]() mutable {sink += a.to_string(10).size();};
+        }},
+        {"to_string_16", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits);
+            return [=]() mutable {sink += a.to_string(16).size();};
+        }},
+        {"from_string_10", any, [](size_t bits) -> body {
+            std::string s = random_bigint(bits).to_string(10);
+            BigInt r;
+            return [=]() mutable {r.from_cstr(s.c_str(), 10); sink += r.bit_size();};
+        }},
+        {"from_string_16", any, [](size_t bits) -> body {
+            std::string s = random_bigint(bits).to_string(16);
+            BigInt r;
+            return [=]() mutable {r.from_cstr(s.c_str(), 16); sink += r.bit_size();};
+        }},
+        {"isqrt", any, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits);
+            return [=]() mutable {sink += a.isqrt().bit_size();};
+        }},
+        {"gcd", 1u << 21, [](size_t bits) -> body {
+            BigInt a = random_bigint(bits), b = random_bigint(bits);
+            return [=]() mutable {sink += gcd(a, b).bit_size();};
+        }},
+        {"powmod", 1u << 14, [](size_t bits) -> body {
+            BigInt m = random_bigint(bits), b = random_bigint(bits), e = random_bigint(bits);
+            if (m % 2 == 0) ++m;
+            MontgomeryContext ctx(m);
+            return [=]() mutable {sink += ctx.powmod(b, e).bit_size();};
+        }},
+        {"is_probable_prime", 1u << 12, [](size_t bits) -> body {
+            // a prime, so every stage runs to the end; finding it is most of the setup time
+            BigInt p = random_bigint(bits).next_prime();
+            return [=]() mutable {sink += p.is_probable_prime();};
+        }},
+        {"small_mix", 64, [](size_t) -> body {
+            // the everyday mix on values that fit a limb: no allocation expected
+            BigInt a = 123456789, b = -987654321, c;
+            int i = 0;
+            return [=]() mutable {
+                c = a + b;
+                c = a * b;
+                c += a;
+                c -= b;
+                c++;
+                c = ++i;
+                sink += c.bit_size();
+            };
+        }},
+    };
+}
+
+struct Result {
+    std::string op;
+    size_t bits;
+    size_t iterations;
+    double seconds;
+    size_t allocs;
+};
+
+Result measure(const Op& op, size_t bits, double min_time){
+    // the iteration count doubles until a batch takes min_time
+    std::function<void()> f = op.prepare(bits);
+    f(); // warm up caches and scratch pools
+    size_t n = 1;
+    for (;;){
+        size_t before = allocation_count();
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t i=0; i<n; ++i) f();
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if ((t >= min_time) || (n >= (static_cast<size_t>(1) << 40)))
+            return {op.name, bits, n, t, allocation_count() - before};
+        n *= ((t > 0) ? std::max<size_t>(2, std::min<size_t>(16, static_cast<size_t>(min_time / t))) : 16);
+    }
+}
+
+void write_csv(FILE* f, const std::vector<Result>& results){
+    std::fprintf(f, "op,bits,limbs,iterations,ns_per_op,ops_per_sec,bits_per_sec,allocs_per_op\n");
+    for (const Result& r : results){
+        double per_op = r.seconds / r.iterations;
+        std::fprintf(f, "%s,%zu,%zu,%zu,%.1f,%.6g,%.6g,%.3f\n", r.op.c_str(), r.bits,
+                     (r.bits + BigInt::limb_bits - 1) / BigInt::limb_bits, r.iterations, per_op * 1e9,
+                     1 / per_op, r.bits / per_op, static_cast<double>(r.allocs) / r.iterations);
+    }
+}
+
+void write_json(FILE* f, const std::vector<Result>& results){
+    std::fprintf(f, "{\n  \"limb_bits\": %u,\n  \"threads\": %zu,\n  \"compiler\": \"%s\",\n  \"results\": [\n",
+                 BigInt::limb_bits, BigInt::thread_count, __VERSION__);
+    for (size_t i=0; i<results.size(); ++i){
+        const Result& r = results[i];
+        double per_op = r.seconds / r.iterations;
+        std::fprintf(f, "    {\"op\": \"%s\", \"bits\": %zu, \"limbs\": %zu, \"iterations\": %zu, "
+                        "\"ns_per_op\": %.1f, \"ops_per_sec\": %.6g, \"bits_per_sec\": %.6g, \"allocs_per_op\": %.3f}%s\n",
+                     r.op.c_str(), r.bits, (r.bits + BigInt::limb_bits - 1) / BigInt::limb_bits, r.iterations,
+                     per_op * 1e9, 1 / per_op, r.bits / per_op, static_cast<double>(r.allocs) / r.iterations,
+                     (i+1 < results.size()) ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+int usage(const char* self){
+    std::fprintf(stderr, "usage: %s [--min-bits N] [--max-bits N] [--min-time SECONDS] [--ops a,b,...]\n"
+                         "       [--threads N] [--format json|csv] [--output FILE]\nops:", self);
+    for (const Op& op : all_ops()) std::fprintf(stderr, " %s", op.name);
+    std::fprintf(stderr, "\n");
+    return 2;
+}
+
+}
+
+int main(int argc, char** argv){
+    size_t min_bits = BigInt::limb_bits, max_bits = static_cast<size_t>(1) << 22;
+    double min_time = 0.2;
+    std::string format = "json", output, ops;
+    BigInt::thread_count = 1; // single-thread throughput unless asked for
+    for (int i=1; i<argc; ++i){
+        std::string arg = argv[i];
+        if (i+1 == argc) return usage(argv[0]);
+        const char* val = argv[++i];
+        if (arg == "--min-bits") min_bits = std::strtoull(val, nullptr, 10);
+        else if (arg == "--max-bits") max_bits = std::strtoull(val, nullptr, 10);
+        else if (arg == "--min-time") min_time = std::strtod(val, nullptr);
+        else if (arg == "--ops") ops = std::string(",") + val + ",";
+        else if (arg == "--threads") BigInt::thread_count = std::strtoull(val, nullptr, 10);
+        else if (arg == "--format") format = val;
+        else if (arg == "--output") output = val;
+        else return usage(argv[0]);
+    }
+    if (((format != "json") && (format != "csv")) || (min_bits == 0) || (BigInt::thread_count == 0))
+        return usage(argv[0]);
+
+    std::vector<Result> results;
+    for (const Op& op : all_ops()){
+        if (!ops.empty() && (ops.find(std::string(",") + op.name + ",") == std::string::npos)) continue;
+        for (size_t bits=min_bits; (bits <= max_bits) && (bits <= op.max_bits); bits*=2){
+            results.push_back(measure(op, bits, min_time));
+            const Result& r = results.back();
+            std::fprintf(stderr, "%-18s %9zu bits %12.1f ns\n", r.op.c_str(), r.bits, r.seconds / r.iterations * 1e9);
+        }
+    }
+
+    FILE* f = (output.empty() ? stdout : std::fopen(output.c_str(), "w"));
+    if (!f){
+        std::fprintf(stderr, "can't write %s\n", output.c_str());
+        return 1;
+    }
+    if (format == "csv")
+        write_csv(f, results);
+    else
+        write_json(f, results);
+    if (f != stdout) std::fclose(f);
+    return (sink == 42) ? 3 : 0; // sink is used
+}
@@ -0,0 +1,48 @@
+#ifndef BigIntTest_HPP
+#define BigIntTest_HPP
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include "BigInt.hpp"
+
+// a minimal self-registering test runner: TEST(suite, name) defines a case, CHECK records
+// a failure and goes on; the runner takes suite names on the command line (none runs all)
+
+struct TestRegistrar {
+    TestRegistrar(const char* suite, const char* name, void (*fn)());
+};
+void test_failed(const char* file, int line, const std::string& what);
+
+#define TEST(suite, name) \
+    static void test_##suite##_##name(); \
+    static TestRegistrar registrar_##suite##_##name(#suite, #name, test_##suite##_##name); \
+    static void test_##suite##_##name()
+
+#define CHECK(cond) \
+    do { if (!(cond)) test_failed(__FILE__, __LINE__, #cond); } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { if (!((a) == (b))) test_failed(__FILE__, __LINE__, #a " == " #b); } while (0)
+
+#define CHECK_THROWS(expr, type) \
+    do { \
+        bool thrown_ = false; \
+        try { expr; } catch (const type&) { thrown_ = true; } \
+        if (!thrown_) test_failed(__FILE__, __LINE__, #expr " throws " #type); \
+    } while (0)
+
+// the same seed on every run
+std::mt19937_64& test_rng();
+// bits random bits with the top one set, negative half of the time when signed_ is set
+BigInt random_bigint(size_t bits, bool signed_=false);
+// the crossover, thread and execution settings go back to their values when the scope ends
+class ThresholdGuard {
+    size_t saved[13];
+    BigInt::Execution ex;
+public:
+    ThresholdGuard();
+    ~ThresholdGuard();
+};
+
+#endif // BigIntTest_HPP
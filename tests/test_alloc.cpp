@@ -0,0 +1,147 @@
+#include "test.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// every heap allocation of the test binary is counted
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t n){
+    ++allocations;
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {std::free(p);}
+void operator delete(void* p, size_t) noexcept {std::free(p);}
+
+template <typename F>
+static size_t count_allocations(F f){
+    f(); // the first run fills the scratch pools
+    size_t before = allocations;
+    f();
+    return allocations - before;
+}
+
+TEST(alloc, small_numbers_stay_inline){
+    // up to four limbs live in the BigInt itself
+    BigInt a = 123456789, b = -987654321, c;
+    size_t n = count_allocations([&]{
+        for (int i=0; i<1000; ++i){
+            c = a + b;
+            c = a * b;
+            c += a;
+            c -= b;
+            c++;
+            c = i;
+        }
+    });
+    CHECK_EQ(n, 0u);
+}
+
+TEST(alloc, inline_limit){
+    // four limbs is the most that stays inline: temporaries of +, -, *, x++ and
+    // native assignment at that size don't allocate, a fifth limb takes one heap buffer
+    const unsigned L = BigInt::limb_bits;
+    BigInt a = (BigInt(1) << (4*L - 2)) + 12345, b = (BigInt(1) << (3*L)) - 1;
+    BigInt x = (BigInt(1) << (2*L - 1)) + 1, c, d;
+    size_t n = count_allocations([&]{
+        for (int i=0; i<100; ++i){
+            c = a + b;
+            c = a - b;
+            d = c++;
+            c = x * x;
+            c = static_cast<uint64_t>(i) << 40;
+            d = -a;
+        }
+    });
+    CHECK_EQ(n, 0u);
+    CHECK_EQ((x * x).bit_size(), 4*L - 1);
+    BigInt big = a << L;
+    CHECK_EQ(count_allocations([&]{BigInt t = big;}), 1u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; t <<= L;}), 1u);
+}
+
+TEST(alloc, temporaries_donate_limbs){
+    // 20-limb operands: each expression allocates about once per result it keeps
+    BigInt a = random_bigint(20 * BigInt::limb_bits), b = random_bigint(20 * BigInt::limb_bits);
+    BigInt c = random_bigint(20 * BigInt::limb_bits), d = random_bigint(19 * BigInt::limb_bits);
+    BigInt e = random_bigint(20 * BigInt::limb_bits), r;
+    CHECK(count_allocations([&]{r = a*b + c*d - e;}) <= 2);
+    CHECK(count_allocations([&]{r = ((a << 5) >> 3) + 1;}) <= 2);
+    CHECK(count_allocations([&]{r = (a*b) / c % d;}) <= 5);
+}
+
+TEST(alloc, rvalue_operands_reuse_limbs){
+    // t is a fresh copy either way: as an rvalue operand its limbs become the result,
+    // as an lvalue the result needs a buffer of its own
+    BigInt a = random_bigint(20 * BigInt::limb_bits), b = random_bigint(12 * BigInt::limb_bits), r;
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = t + b;}), 2u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = std::move(t) + b;}), 1u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = b + std::move(t);}), 1u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = t - b;}), 2u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = std::move(t) - b;}), 1u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = b - std::move(t);}), 1u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = -t;}), 2u);
+    CHECK_EQ(count_allocations([&]{BigInt t = a; r = -std::move(t);}), 1u);
+    CHECK_EQ(r, -a);
+}
+
+TEST(alloc, memory_scope){
+    // BigInts made inside the scope take their limbs from the buffer
+    static char buffer[1 << 16];
+    BigInt a = random_bigint(3000), b = random_bigint(3000), kept;
+    count_allocations([&]{BigInt t = a*b;});
+    size_t before = allocations;
+    {
+        std::pmr::monotonic_buffer_resource res(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        BigInt::MemoryScope scope(&res);
+        BigInt x = a*b, y = x + a;
+        y -= b;
+        kept = y; // copied out of the buffer
+    }
+    CHECK_EQ(allocations - before, 1u);
+    CHECK_EQ(kept, a*b + a - b);
+}
+
+// a resource for one thread: counts the allocations made from any other
+class OwnerResource : public std::pmr::memory_resource {
+    std::thread::id owner = std::this_thread::get_id();
+    void* do_allocate(size_t bytes, size_t align) override {
+        if (std::this_thread::get_id() != owner) ++foreign;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        if (std::this_thread::get_id() != owner) ++foreign;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+public:
+    std::atomic<size_t> foreign{0};
+};
+
+TEST(alloc, memory_scope_with_threads){
+    // product() and sum() fork onto the pool, whose workers must stay off the scope's resource
+    ThresholdGuard guard;
+    BigInt::thread_count = 4;
+    BigInt::parallel_threshold = 2;
+    std::vector<BigInt> v;
+    for (int i=0; i<64; ++i) v.push_back(random_bigint(100 * BigInt::limb_bits));
+    BigInt prod = 1, sum = 0;
+    for (const BigInt& x : v){
+        prod *= x;
+        sum += x;
+    }
+    BigInt fact = BigInt::factorial(3000);
+    OwnerResource res;
+    for (int i=0; i<10; ++i){
+        BigInt::MemoryScope scope(&res);
+        CHECK_EQ(BigInt::product(v), prod);
+        CHECK_EQ(BigInt::sum(v), sum);
+        CHECK_EQ(BigInt::factorial(3000), fact);
+    }
+    CHECK_EQ(res.foreign.load(), 0u);
+}
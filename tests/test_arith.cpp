@@ -0,0 +1,323 @@
+#include "test.hpp"
+#include "BigIntAccumulator.hpp"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+static const size_t off = std::numeric_limits<size_t>::max();
+
+static BigInt schoolbook(const BigInt& a, const BigInt& b){
+    ThresholdGuard guard;
+    BigInt::karatsuba_threshold = off;
+    BigInt::ntt_threshold = off;
+    BigInt::sqr_karatsuba_threshold = off;
+    BigInt::thread_count = 1;
+    return a * b;
+}
+
+TEST(arith, mul_tiers_match_schoolbook){
+    // every tier forced from a few limbs on, balanced and unbalanced operands
+    const size_t sizes[] = {1, 2, 3, 5, 8, 13, 17, 32, 33, 64, 100, 161, 399, 500, 1000, 2000};
+    for (size_t sa : sizes){
+        for (size_t sb : sizes){
+            if ((sa > 400) && (sb > 400) && (sa != sb)) continue;
+            BigInt a = random_bigint(sa * BigInt::limb_bits, true), b = random_bigint(sb * BigInt::limb_bits, true);
+            BigInt ref = schoolbook(a, b);
+            for (int mode=0; mode<5; ++mode){
+                ThresholdGuard guard;
+                BigInt::ntt_threshold = off;
+                if (mode >= 1) BigInt::karatsuba_threshold = 2;
+                if (mode == 1) BigInt::toom3_threshold = off;
+                if (mode >= 2) BigInt::toom3_threshold = 9;
+                if (mode == 2) BigInt::toom4_threshold = off;
+                if (mode >= 3) BigInt::toom4_threshold = 16;
+                if (mode == 4) BigInt::ntt_threshold = 2;
+                CHECK_EQ(a * b, ref);
+            }
+        }
+    }
+}
+
+static BigInt by_rows(const BigInt& a, const BigInt& b){
+    // schoolbook from 32-bit rows of b, through native multiplications only
+    BigInt res = 0, m = b.abs();
+    for (uint64_t shift=0; m != 0; shift += 32){
+        uint64_t row;
+        m.div(static_cast<uint64_t>(1) << 32, row);
+        res.add_shifted(a * static_cast<uint32_t>(row), shift);
+    }
+    return ((b < 0) ? -res : res);
+}
+
+TEST(arith, mul_tiers_match_rows){
+    // all-ones limbs carry through every column; odd sizes and the uneven splits of each tier
+    for (size_t n : {3, 7, 9, 17, 31, 65, 127, 255}){
+        BigInt ones = (BigInt(1) << (n * BigInt::limb_bits)) - 1;
+        for (size_t m : {n, n-1, n/2 + 1, n/3 + 1, 2*n/3 + 1}){
+            BigInt other = (m & 1) ? (BigInt(1) << (m * BigInt::limb_bits)) - 1 : -random_bigint(m * BigInt::limb_bits);
+            BigInt ref = by_rows(ones, other);
+            for (int mode=0; mode<4; ++mode){
+                ThresholdGuard guard;
+                BigInt::ntt_threshold = off;
+                BigInt::karatsuba_threshold = (mode >= 1) ? 2 : off;
+                BigInt::toom3_threshold = (mode >= 2) ? 3 : off;
+                BigInt::toom4_threshold = (mode >= 3) ? 4 : off;
+                CHECK_EQ(ones * other, ref);
+                CHECK_EQ(other * ones, ref);
+                CHECK_EQ(ones.square(), by_rows(ones, ones));
+            }
+        }
+    }
+}
+
+TEST(arith, sqr_tiers_match_schoolbook){
+    for (size_t n : {1, 2, 3, 7, 16, 31, 32, 60, 150, 400, 1300, 3000}){
+        BigInt a = random_bigint(n * BigInt::limb_bits, true);
+        BigInt ref = schoolbook(a, BigInt(a));
+        for (int mode=0; mode<4; ++mode){
+            ThresholdGuard guard;
+            BigInt::ntt_threshold = (mode == 3) ? 2 : off;
+            if (mode >= 1) BigInt::sqr_karatsuba_threshold = 2;
+            BigInt::sqr_toom3_threshold = (mode >= 2) ? 9 : off;
+            BigInt::sqr_toom4_threshold = (mode >= 2) ? 16 : off;
+            CHECK_EQ(a.square(), ref);
+            BigInt b = a;
+            b *= b;
+            CHECK_EQ(b, ref);
+        }
+    }
+}
+
+TEST(arith, parallel_mul_matches_serial){
+    ThresholdGuard guard;
+    BigInt::thread_count = 4;
+    BigInt::parallel_threshold = 16;
+    for (size_t n : {20, 100, 700, 5000, 20000}){
+        BigInt a = random_bigint(n * BigInt::limb_bits, true), b = random_bigint((n/3 + 1) * BigInt::limb_bits, true);
+        BigInt c = random_bigint(n * BigInt::limb_bits);
+        CHECK_EQ(multiplied(a, b, BigInt::Execution::parallel), multiplied(a, b, BigInt::Execution::serial));
+        CHECK_EQ(multiplied(a, c, BigInt::Execution::parallel), schoolbook(a, c));
+        CHECK_EQ(c.square(BigInt::Execution::parallel), c.square(BigInt::Execution::serial));
+    }
+}
+
+TEST(arith, small_values_match_native){
+    // C++ semantics on values that fit: truncating division, remainder with the dividend's sign
+    std::mt19937_64& rng = test_rng();
+    for (int i=0; i<20000; ++i){
+        int64_t a = static_cast<int32_t>(rng()), b = static_cast<int32_t>(rng());
+        if (i % 7 == 0) a %= 100;
+        if (i % 5 == 0) b %= 10;
+        BigInt x = a, y = b;
+        CHECK_EQ(x + y, BigInt(a + b));
+        CHECK_EQ(x - y, BigInt(a - b));
+        CHECK_EQ(x * y, BigInt(a * b));
+        CHECK_EQ(x < y, a < b);
+        CHECK_EQ(x == y, a == b);
+        if (b == 0){
+            CHECK_THROWS(x / y, std::invalid_argument);
+            continue;
+        }
+        CHECK_EQ(x / y, BigInt(a / b));
+        CHECK_EQ(x % y, BigInt(a % b));
+        CHECK_EQ(x / b, BigInt(a / b));
+        CHECK_EQ(x % b, BigInt(a % b));
+    }
+    CHECK(!(-BigInt(0) < 0));
+    CHECK_EQ((BigInt(5) - 5).to_string(), "0");
+}
+
+TEST(arith, native_operands_match_bigint){
+    std::mt19937_64& rng = test_rng();
+    const int64_t edges[] = {0, 1, -1, INT32_MIN, INT32_MAX, INT64_MIN, INT64_MAX};
+    for (int i=0; i<3000; ++i){
+        BigInt x = random_bigint(1 + rng() % 300, true);
+        int64_t s = ((i < 7) ? edges[i] : static_cast<int64_t>(rng() >> (rng() % 64)) * ((rng() & 1) ? 1 : -1));
+        uint64_t u = rng() >> (rng() % 64);
+        BigInt bs = s, bu = u;
+        CHECK_EQ(x + s, x + bs);
+        CHECK_EQ(x - s, x - bs);
+        CHECK_EQ(x * s, x * bs);
+        CHECK_EQ(x * u, x * bu);
+        CHECK_EQ(x < s, x < bs);
+        CHECK_EQ(x == u, x == bu);
+        if (s){
+            BigInt q = x;
+            q /= s;
+            CHECK_EQ(q, x / bs);
+            CHECK_EQ(x % s, x % bs);
+        }
+        BigInt y = x;
+        y.addmul(x, s);
+        CHECK_EQ(y, x + x * bs);
+        y = x;
+        y.submul(x, u);
+        CHECK_EQ(y, x - x * bu);
+        int32_t d = static_cast<int32_t>(rng() | 1), rem;
+        BigInt q = x;
+        q.div(d, rem);
+        CHECK_EQ(q, x / BigInt(d));
+        CHECK_EQ(BigInt(rem), x % BigInt(d));
+    }
+}
+
+TEST(arith, add_sub_identities){
+    for (int i=0; i<2000; ++i){
+        BigInt a = random_bigint(1 + test_rng()() % 3000, true), b = random_bigint(1 + test_rng()() % 3000, true);
+        BigInt s = a + b;
+        CHECK_EQ(s - b, a);
+        CHECK_EQ(a - b, -(b - a));
+        CHECK_EQ(BigInt(a) + BigInt(b), s);
+        CHECK_EQ(a - BigInt(b), a + (-b));
+        BigInt c = a;
+        c += c;
+        CHECK_EQ(c, a * 2);
+        c -= c;
+        CHECK_EQ(c, 0);
+    }
+}
+
+TEST(arith, increments_cross_limbs){
+    BigInt x = (BigInt(1) << 128) - 1;
+    BigInt y = x++;
+    CHECK_EQ(y + 1, x);
+    CHECK_EQ(x.bit_size(), 129u);
+    --x;
+    CHECK_EQ(x.bit_size(), 128u);
+    BigInt z = -1;
+    ++z;
+    CHECK_EQ(z, 0);
+    CHECK(!(z < 0));
+    --z;
+    CHECK_EQ(z, -1);
+}
+
+TEST(arith, division_identity){
+    // q*b + r == a with |r| < |b| and r of the sign of a, through every division tier
+    const size_t sizes[] = {1, 2, 3, 10, 40, 100, 300, 1000, 3000};
+    for (size_t sa : sizes){
+        for (size_t sb : sizes){
+            if (sb > sa + 3) continue;
+            BigInt a = random_bigint(sa * BigInt::limb_bits, true), b = random_bigint(sb * BigInt::limb_bits - (sb & 7), true);
+            BigInt q_ref, r_ref;
+            {
+                ThresholdGuard guard;
+                BigInt::bz_threshold = off;
+                BigInt::newton_threshold = off;
+                q_ref = divided(a, b, r_ref);
+            }
+            CHECK_EQ(q_ref * b + r_ref, a);
+            CHECK(r_ref.abs() < b.abs());
+            CHECK(r_ref == 0 || ((r_ref < 0) == (a < 0)));
+            for (int mode=0; mode<3; ++mode){
+                ThresholdGuard guard;
+                if (mode >= 1) BigInt::bz_threshold = 4;
+                if (mode == 2) BigInt::newton_threshold = 4;
+                BigInt r;
+                CHECK_EQ(divided(a, b, r), q_ref);
+                CHECK_EQ(r, r_ref);
+                CHECK_EQ(a / b, q_ref);
+                CHECK_EQ(a % b, r_ref);
+            }
+        }
+    }
+    BigInt a = 17;
+    CHECK_THROWS(a /= BigInt(0), std::invalid_argument);
+    CHECK_THROWS(a % 0, std::invalid_argument);
+}
+
+TEST(arith, division_aliasing){
+    BigInt a = random_bigint(5000, true), b = random_bigint(2000, true);
+    BigInt r_ref;
+    BigInt q_ref = divided(a, b, r_ref);
+    BigInt x = a, y = b;
+    x.div(y, x); // remain is *this: the remainder is kept
+    CHECK_EQ(x, r_ref);
+    x = a;
+    x.div(y, y); // remain is the divisor
+    CHECK_EQ(x, q_ref);
+    CHECK_EQ(y, r_ref);
+    x = a;
+    x.div(x, y);
+    CHECK_EQ(x, 1);
+    CHECK_EQ(y, 0);
+    x = a;
+    CHECK_EQ(std::move(x) / b, q_ref);
+}
+
+TEST(arith, shifts){
+    for (int i=0; i<500; ++i){
+        BigInt a = random_bigint(1 + test_rng()() % 2000, true);
+        uint64_t k = test_rng()() % 700;
+        BigInt pow2("1" + std::string(k, '0'), 2);
+        CHECK_EQ(a << k, a * pow2);
+        CHECK_EQ((a << k) >> k, a);
+        CHECK_EQ(a.abs() >> k, a.abs() / pow2);
+        BigInt b = a;
+        b <<= k;
+        b >>= k;
+        CHECK_EQ(b, a);
+    }
+    CHECK_EQ(BigInt(1) >> 1, 0);
+}
+
+TEST(arith, fused_ops){
+    for (int i=0; i<500; ++i){
+        BigInt a = random_bigint(1 + test_rng()() % 3000, true), b = random_bigint(1 + test_rng()() % 3000, true);
+        BigInt c = random_bigint(1 + test_rng()() % 3000, true);
+        uint64_t k = test_rng()() % 500;
+        BigInt x = a;
+        x.addmul(b, c);
+        CHECK_EQ(x, a + b*c);
+        x = a;
+        x.submul(b, c);
+        CHECK_EQ(x, a - b*c);
+        x = a;
+        x.addmul(x, x); // every operand aliased
+        CHECK_EQ(x, a + a*a);
+        x = a;
+        x.add_shifted(b, k);
+        CHECK_EQ(x, a + (b << k));
+        x = a;
+        x.sub_shifted(b, k);
+        CHECK_EQ(x, a - (b << k));
+    }
+}
+
+TEST(arith, accumulator){
+    BigIntAccumulator acc;
+    BigInt ref = 0;
+    for (int i=0; i<3000; ++i){
+        BigInt a = random_bigint(1 + test_rng()() % 1000, true), b = random_bigint(1 + test_rng()() % 200, true);
+        switch (i % 5){
+        case 0: acc.add(a); ref += a; break;
+        case 1: acc.sub(a); ref -= a; break;
+        case 2: acc.addmul(a, b); ref += a*b; break;
+        case 3: acc.submul(a, b); ref -= a*b; break;
+        default:
+            int64_t s = static_cast<int64_t>(test_rng()());
+            acc.add(s);
+            ref += s;
+        }
+        if (i % 500 == 0) CHECK_EQ(acc.result(), ref);
+    }
+}
+
+TEST(arith, product_and_sum){
+    ThresholdGuard guard;
+    std::vector<BigInt> v;
+    BigInt prod = 1, sum = 0;
+    for (int i=0; i<300; ++i){
+        v.push_back(random_bigint(1 + test_rng()() % 2000, true));
+        prod *= v.back();
+        sum += v.back();
+    }
+    for (size_t threads : {1, 4}){
+        BigInt::thread_count = threads;
+        BigInt::parallel_threshold = 64;
+        CHECK_EQ(BigInt::product(v), prod);
+        CHECK_EQ(BigInt::sum(v), sum);
+        CHECK_EQ(BigInt::product(v.begin(), v.begin()), 1);
+        CHECK_EQ(BigInt::sum(v.begin(), v.begin()), 0);
+    }
+}
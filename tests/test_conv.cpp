@@ -0,0 +1,120 @@
+#include "test.hpp"
+#include <cstdint>
+#include <limits>
+#include <string>
+
+static const char digit_chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static std::string slow_to_string(BigInt x, unsigned base){
+    // one native division per digit
+    if (x == 0) return "0";
+    bool negative = (x < 0);
+    x = x.abs();
+    std::string res;
+    while (x != 0){
+        unsigned d;
+        x.div(base, d);
+        res += digit_chars[d];
+    }
+    if (negative) res += '-';
+    return std::string(res.rbegin(), res.rend());
+}
+
+static BigInt slow_from_string(const std::string& s, unsigned base){
+    BigInt res = 0;
+    for (char c : s){
+        if (c == '-') continue;
+        res *= base;
+        res += static_cast<int>(std::string(digit_chars).find(c));
+    }
+    return ((s[0] == '-') ? -res : res);
+}
+
+TEST(conv, round_trip_every_base){
+    for (unsigned base=2; base<=36; ++base){
+        for (size_t bits : {1, 31, 32, 33, 63, 64, 65, 200, 1000, 5000, 40000}){
+            BigInt x = random_bigint(bits, true);
+            std::string s = x.to_string(static_cast<uint8_t>(base));
+            CHECK_EQ(BigInt(s, static_cast<uint8_t>(base)), x);
+        }
+    }
+}
+
+TEST(conv, matches_digit_by_digit){
+    // both radix conversion tiers against one digit at a time
+    for (size_t radix : {std::numeric_limits<size_t>::max(), static_cast<size_t>(2)}){
+        ThresholdGuard guard;
+        BigInt::radix_threshold = radix;
+        for (unsigned base : {3, 7, 10, 16, 36}){
+            for (size_t bits : {1, 64, 65, 500, 3000}){
+                BigInt x = random_bigint(bits, true);
+                std::string s = slow_to_string(x, base);
+                CHECK_EQ(x.to_string(static_cast<uint8_t>(base)), s);
+                CHECK_EQ(BigInt(s, static_cast<uint8_t>(base)), x);
+                CHECK_EQ(slow_from_string(s, base), x);
+            }
+        }
+    }
+}
+
+TEST(conv, prefixes_and_default_base){
+    CHECK_EQ(BigInt("0x1F"), 31);
+    CHECK_EQ(BigInt("0b101"), 5);
+    CHECK_EQ(BigInt("017"), 15);
+    CHECK_EQ(BigInt("-0x10"), -16);
+    CHECK_EQ(BigInt("  42"), 42);
+    CHECK_EQ(BigInt("0b 1111 1111"), 255);
+    CHECK_EQ(BigInt("0x10", 16), 16);
+    CHECK_EQ(BigInt("0"), 0);
+    CHECK_EQ(BigInt("-0").to_string(), "0");
+    BigInt x = 255;
+    CHECK_EQ(x.to_string(16), "ff");
+    CHECK_EQ((-x).to_string(2), "-11111111");
+    x.set_def_base(16);
+    CHECK_EQ(x.get_def_base(), 16);
+    CHECK_EQ(x.to_string(), "ff");
+    BigInt y = x;
+    CHECK_EQ((x*y).to_string(), "fe01");
+    CHECK_EQ((x*x).to_string(), "fe01");
+    CHECK_EQ(x.square().to_string(), "fe01");
+    CHECK_EQ(multiplied(x, x, BigInt::Execution::serial).to_string(), "fe01");
+    // the result takes the base of the left operand, also when the right one is a temporary
+    BigInt z = 3;
+    z.set_def_base(2);
+    CHECK_EQ((x + z).to_string(), "102");
+    CHECK_EQ((x + BigInt(z)).to_string(), "102");
+    CHECK_EQ((x - BigInt(z)).to_string(), "fc");
+    CHECK_EQ((BigInt(x) + BigInt(z)).to_string(), "102");
+    CHECK_EQ((BigInt(x) - BigInt(z)).to_string(), "fc");
+    CHECK_EQ((z + BigInt(x)).to_string(), "100000010");
+    CHECK_EQ((z - BigInt(x)).to_string(), "-11111100");
+    // and with a native right operand
+    CHECK_EQ((x % 128u).to_string(), "7f");
+    CHECK_EQ((x % 100).to_string(), "37");
+    const BigInt neg_x = -x;
+    CHECK_EQ((neg_x % 100).to_string(), "-37");
+    CHECK_EQ((x / 7u).to_string(), "24");
+    CHECK_EQ((x * 7u).to_string(), "6f9");
+    CHECK_EQ((x + 1).to_string(), "100");
+    CHECK_EQ((x - 256).to_string(), "-1");
+    char buf[64];
+    CHECK_EQ(std::string(BigInt(-255).to_cstr(buf, 8)), "-377");
+}
+
+TEST(conv, native_limits){
+    CHECK_EQ(BigInt(INT64_MIN).to_string(), "-9223372036854775808");
+    CHECK_EQ(BigInt(INT64_MAX).to_string(), "9223372036854775807");
+    CHECK_EQ(BigInt(UINT64_MAX).to_string(16), "ffffffffffffffff");
+    CHECK_EQ(BigInt(static_cast<int8_t>(-128)), -128);
+    BigInt x;
+    x = UINT64_MAX;
+    CHECK_EQ(x + 1, BigInt("18446744073709551616"));
+    CHECK_EQ(BigInt('7'), 7);
+    CHECK_EQ(BigInt(true), 1);
+}
+
+TEST(conv, invalid_input){
+    CHECK_THROWS(BigInt("12", 1), std::invalid_argument);
+    CHECK_THROWS(BigInt("12", 37), std::invalid_argument);
+    CHECK_THROWS(BigInt(5).to_string(37), std::invalid_argument);
+}
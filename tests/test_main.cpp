@@ -0,0 +1,94 @@
+#include "test.hpp"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace {
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    void (*fn)();
+};
+
+std::vector<TestCase>& registry(){
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+size_t failures = 0;
+
+}
+
+TestRegistrar::TestRegistrar(const char* suite, const char* name, void (*fn)()){
+    registry().push_back({suite, name, fn});
+}
+
+void test_failed(const char* file, int line, const std::string& what){
+    ++failures;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what.c_str());
+}
+
+std::mt19937_64& test_rng(){
+    static std::mt19937_64 rng(20261018);
+    return rng;
+}
+
+BigInt random_bigint(size_t bits, bool signed_){
+    // hex digits, so the number is built by the linear-time power-of-two path
+    if (bits == 0) return BigInt(0);
+    static const char digits[] = "0123456789abcdef";
+    std::mt19937_64& rng = test_rng();
+    unsigned top = bits % 4; // bits of a leading partial digit
+    std::string s;
+    if (top) s += digits[(1u << (top - 1)) | (rng() & ((1u << (top - 1)) - 1))];
+    for (size_t i=0; i<bits/4; ++i) s += digits[rng() & 15];
+    if (!top) s[0] = digits[8 | (rng() & 7)];
+    BigInt x(s, 16);
+    return ((signed_ && (rng() & 1)) ? -x : x);
+}
+
+ThresholdGuard::ThresholdGuard() : ex(BigInt::execution){
+    size_t* p = saved;
+    for (size_t v : {BigInt::karatsuba_threshold, BigInt::toom3_threshold, BigInt::toom4_threshold,
+                     BigInt::ntt_threshold, BigInt::sqr_karatsuba_threshold, BigInt::sqr_toom3_threshold,
+                     BigInt::sqr_toom4_threshold, BigInt::bz_threshold, BigInt::newton_threshold,
+                     BigInt::radix_threshold, BigInt::hgcd_threshold, BigInt::thread_count,
+                     BigInt::parallel_threshold})
+        *p++ = v;
+}
+ThresholdGuard::~ThresholdGuard(){
+    const size_t* p = saved;
+    for (size_t* v : {&BigInt::karatsuba_threshold, &BigInt::toom3_threshold, &BigInt::toom4_threshold,
+                      &BigInt::ntt_threshold, &BigInt::sqr_karatsuba_threshold, &BigInt::sqr_toom3_threshold,
+                      &BigInt::sqr_toom4_threshold, &BigInt::bz_threshold, &BigInt::newton_threshold,
+                      &BigInt::radix_threshold, &BigInt::hgcd_threshold, &BigInt::thread_count,
+                      &BigInt::parallel_threshold})
+        *v = *p++;
+    BigInt::execution = ex;
+}
+
+int main(int argc, char** argv){
+    size_t run = 0;
+    for (const TestCase& t : registry()){
+        bool selected = (argc < 2);
+        for (int i=1; i<argc; ++i)
+            if (std::strcmp(argv[i], t.suite) == 0) selected = true;
+        if (!selected) continue;
+        size_t before = failures;
+        try {
+            t.fn();
+        } catch (const std::exception& e){
+            test_failed(t.suite, 0, std::string(t.name) + " threw " + e.what());
+        }
+        std::printf("%-10s %-28s %s\n", t.suite, t.name, (failures == before) ? "ok" : "FAILED");
+        ++run;
+    }
+    if (run == 0){
+        std::fprintf(stderr, "no test selected\n");
+        return 1;
+    }
+    std::printf("%zu tests, %zu failed checks\n", run, failures);
+    return (failures ? 1 : 0);
+}
@@ -0,0 +1,121 @@
+#include "test.hpp"
+#include "BarrettReducer.hpp"
+#include "MontgomeryContext.hpp"
+#include <vector>
+
+static BigInt reduced(const BigInt& x, const BigInt& m){
+    BigInt r = x % m;
+    return ((r < 0) ? r + m : r);
+}
+
+static BigInt slow_powmod(BigInt b, BigInt e, const BigInt& m){
+    BigInt res = reduced(1, m);
+    b = reduced(b, m);
+    while (e != 0){
+        if (e % 2 == 1) res = res * b % m;
+        b = b * b % m;
+        e /= 2;
+    }
+    return res;
+}
+
+TEST(modular, montgomery_matches_division){
+    for (size_t bits : {2, 31, 64, 65, 200, 1000, 3000}){
+        BigInt m = random_bigint(bits);
+        if (m % 2 == 0) ++m;
+        MontgomeryContext ctx(m);
+        CHECK_EQ(ctx.modulus(), m);
+        for (int i=0; i<10; ++i){
+            BigInt a = random_bigint(1 + test_rng()() % (2*bits), true), b = random_bigint(1 + test_rng()() % bits, true);
+            CHECK_EQ(ctx.mulmod(a, b), reduced(a*b, m));
+            CHECK_EQ(ctx.sqrmod(a), reduced(a*a, m));
+            if (bits <= 1000){
+                BigInt e = random_bigint(1 + test_rng()() % 300);
+                CHECK_EQ(ctx.powmod(a, e), slow_powmod(a, e, m));
+            }
+        }
+        CHECK_EQ(ctx.powmod(5, 0), reduced(1, m));
+        CHECK_THROWS(ctx.powmod(5, -1), std::invalid_argument);
+    }
+    CHECK_THROWS(MontgomeryContext(BigInt(10)), std::invalid_argument);
+    CHECK_THROWS(MontgomeryContext(BigInt(-7)), std::invalid_argument);
+}
+
+TEST(modular, barrett_matches_division){
+    for (size_t bits : {1, 2, 64, 65, 300, 2000, 10000}){
+        BigInt m = random_bigint(bits);
+        BarrettReducer red(m);
+        CHECK_EQ(red.modulus(), m);
+        std::vector<BigInt> v, ref;
+        for (int i=0; i<20; ++i){
+            BigInt x = random_bigint(1 + test_rng()() % (2*bits));
+            CHECK_EQ(red.reduce(x), x % m);
+            v.push_back(x);
+            ref.push_back(x % m);
+        }
+        red.reduce(v);
+        CHECK(v == ref);
+    }
+}
+
+TEST(modular, gcd_and_bezout){
+    for (size_t hgcd : {BigInt::hgcd_threshold, static_cast<size_t>(3)}){
+        ThresholdGuard guard;
+        BigInt::hgcd_threshold = hgcd;
+        for (size_t bits : {1, 40, 64, 100, 1000, 8000, 30000}){
+            for (int i=0; i<4; ++i){
+                BigInt g = random_bigint(1 + test_rng()() % (bits/2 + 1));
+                BigInt a = random_bigint(bits, true) * g, b = random_bigint(1 + test_rng()() % bits, true) * g;
+                BigInt d = gcd(a, b);
+                CHECK(d >= g);
+                CHECK_EQ(a % d, 0);
+                CHECK_EQ(b % d, 0);
+                CHECK_EQ(gcd(a / d, b / d), 1);
+                BigInt x, y;
+                CHECK_EQ(xgcd(a, b, x, y), d);
+                CHECK_EQ(a*x + b*y, d);
+                CHECK(x.abs() <= b.abs() / d);
+                BigInt a2 = a, b2 = b;
+                xgcd(a2, b2, a2, b2); // the cofactors over the inputs
+                CHECK_EQ(a2, x);
+                CHECK_EQ(b2, y);
+            }
+        }
+    }
+    BigInt x, y;
+    CHECK_EQ(gcd(0, 0), 0);
+    CHECK_EQ(gcd(-12, 0), 12);
+    CHECK_EQ(xgcd(0, -5, x, y), 5);
+    CHECK_EQ(y, -1);
+}
+
+TEST(modular, fibonacci_worst_case){
+    // every quotient is 1
+    BigInt a = 1, b = 0;
+    for (int i=0; i<20000; ++i){
+        a += b;
+        std::swap(a, b);
+    }
+    BigInt x, y;
+    CHECK_EQ(xgcd(a, b, x, y), 1);
+    CHECK_EQ(a*x + b*y, 1);
+}
+
+TEST(modular, modinv){
+    for (size_t bits : {2, 64, 500, 5000}){
+        BigInt m = random_bigint(bits);
+        for (int i=0; i<5; ++i){
+            BigInt a = random_bigint(1 + test_rng()() % (2*bits), true);
+            if (gcd(a, m) != 1){
+                CHECK_THROWS(modinv(a, m), std::invalid_argument);
+                continue;
+            }
+            BigInt inv = modinv(a, m);
+            CHECK(inv >= 0 && inv < m);
+            CHECK_EQ(reduced(a * inv, m), reduced(1, m));
+        }
+    }
+    CHECK_THROWS(modinv(3, 0), std::invalid_argument);
+    CHECK_THROWS(modinv(3, -7), std::invalid_argument);
+    CHECK_THROWS(modinv(6, 9), std::invalid_argument);
+}
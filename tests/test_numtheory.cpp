@@ -0,0 +1,144 @@
+#include "test.hpp"
+#include <cstdint>
+#include <vector>
+
+static std::vector<bool> sieve(size_t n){
+    std::vector<bool> prime(n+1, true);
+    prime[0] = prime[1] = false;
+    for (size_t p=2; p*p<=n; ++p)
+        if (prime[p])
+            for (size_t q=p*p; q<=n; q+=p) prime[q] = false;
+    return prime;
+}
+
+static BigInt power(const BigInt& x, uint64_t k){
+    BigInt res = 1;
+    for (uint64_t i=0; i<k; ++i) res *= x;
+    return res;
+}
+
+TEST(numtheory, factorial_binomial_primorial){
+    BigInt f = 1;
+    for (uint64_t n=0; n<=1200; ++n){
+        if (n) f *= n;
+        if ((n < 300) || (n % 97 == 0)) CHECK_EQ(BigInt::factorial(n), f);
+    }
+    std::vector<BigInt> row = {1};
+    for (uint64_t n=1; n<=80; ++n){
+        std::vector<BigInt> next(n+1, 1);
+        for (uint64_t k=1; k<n; ++k) next[k] = row[k-1] + row[k];
+        row = next;
+        for (uint64_t k=0; k<=n+1; ++k) CHECK_EQ(BigInt::binomial(n, k), (k <= n) ? row[k] : BigInt(0));
+    }
+    for (uint64_t n : {1000, 5000}){
+        for (uint64_t k : {1, 7, 64, 200, 2500}){
+            if (k > n) continue;
+            CHECK_EQ(BigInt::binomial(n, k), BigInt::factorial(n) / (BigInt::factorial(k) * BigInt::factorial(n-k)));
+        }
+    }
+    std::vector<bool> prime = sieve(3000);
+    BigInt p = 1;
+    for (uint64_t n=0; n<=3000; ++n){
+        if (prime[n]) p *= n;
+        if ((n < 100) || (n % 101 == 0)) CHECK_EQ(BigInt::primorial(n), p);
+    }
+}
+
+TEST(numtheory, integer_roots){
+    for (size_t bits : {1, 10, 52, 53, 64, 100, 1000, 20000}){
+        for (uint64_t k : {2, 3, 5, 7, 64}){
+            BigInt x = random_bigint(bits, (k & 1));
+            BigInt rem;
+            BigInt r = x.iroot(k, rem);
+            CHECK_EQ(power(r, k) + rem, x);
+            BigInt next = (x < 0) ? r - 1 : r + 1;
+            CHECK(power(next, k).abs() > x.abs());
+            CHECK_EQ(x.iroot(k), r);
+            if (k == 2){
+                CHECK_EQ(x.isqrt(), r);
+                BigInt rem2;
+                CHECK_EQ(x.isqrt(rem2), r);
+                CHECK_EQ(rem2, rem);
+            }
+        }
+    }
+    // k at or past the bit length: the root is 1, and 2^k is never computed
+    for (size_t bits : {1, 7, 64, 65, 1000}){
+        BigInt x = random_bigint(bits), rem;
+        for (uint64_t k : {static_cast<uint64_t>(bits), static_cast<uint64_t>(bits) + 1,
+                           static_cast<uint64_t>(1) << 34, static_cast<uint64_t>(1) << 40}){
+            if (k < 2) continue;
+            CHECK_EQ(x.iroot(k, rem), 1);
+            CHECK_EQ(rem, x - 1);
+            CHECK_EQ((-x).iroot(k | 1), -1);
+        }
+        if (bits > 2) CHECK_EQ(x.iroot(bits - 1), 2); // 2^(bits-1) <= x < 3^(bits-1)
+    }
+    CHECK_EQ(BigInt(100).iroot(static_cast<uint64_t>(1) << 34), 1);
+    CHECK_EQ(BigInt(1).iroot(static_cast<uint64_t>(1) << 40), 1);
+    CHECK_THROWS(BigInt(-4).isqrt(), std::invalid_argument);
+    CHECK_THROWS(BigInt(4).iroot(0), std::invalid_argument);
+    CHECK_EQ(BigInt(-27).iroot(3), -3);
+}
+
+TEST(numtheory, perfect_powers){
+    BigInt root;
+    uint64_t k;
+    for (uint64_t e : {2, 3, 6, 7, 12, 31}){
+        BigInt b = random_bigint(1 + test_rng()() % 200);
+        if (b < 2) b = 3;
+        BigInt x = power(b, e);
+        CHECK(x.is_perfect_power(root, k));
+        CHECK_EQ(power(root, k), x);
+        CHECK(k >= e);
+        CHECK(!(x + 1).is_perfect_power());
+    }
+    CHECK(BigInt(-8).is_perfect_power(root, k));
+    CHECK_EQ(root, -2);
+    CHECK_EQ(k, 3u);
+    CHECK(!BigInt(-16).is_perfect_power());
+    CHECK(BigInt(1).is_perfect_power());
+    CHECK(!BigInt(2).is_perfect_power());
+}
+
+TEST(numtheory, primality){
+    std::vector<bool> prime = sieve(100000);
+    for (uint64_t n=0; n<=100000; ++n) CHECK_EQ(BigInt(n).is_probable_prime(), prime[n]);
+    CHECK(!BigInt(-7).is_probable_prime());
+    // Carmichael numbers, strong pseudoprimes to base 2, extra strong Lucas pseudoprimes
+    for (uint64_t n : {561ull, 41041ull, 825265ull, 2047ull, 3215031751ull, 3825123056546413051ull,
+                       989ull, 5777ull, 10877ull, 1000000007ull * 1000000009ull})
+        CHECK(!BigInt(n).is_probable_prime());
+    for (uint64_t e : {61, 89, 107, 127, 521, 607})
+        CHECK(((BigInt(1) << e) - 1).is_probable_prime(2));
+    CHECK(!((BigInt(1) << 128) + 1).is_probable_prime());
+    CHECK(!((BigInt(1) << 523) - 1).is_probable_prime());
+    BigInt p = (BigInt(1) << 127) - 1;
+    CHECK(!(p * p).is_probable_prime());
+    CHECK(!(p * ((BigInt(1) << 89) - 1)).is_probable_prime());
+}
+
+TEST(numtheory, next_prime_and_batch){
+    std::vector<bool> prime = sieve(20000);
+    BigInt p = -5;
+    for (uint64_t n=2; n<=20000; ++n){
+        if (!prime[n]) continue;
+        p = p.next_prime();
+        CHECK_EQ(p, n);
+    }
+    BigInt q = BigInt(1) << 400;
+    BigInt r = q.next_prime();
+    CHECK(r.is_probable_prime());
+    for (BigInt c = q + 1; c < r; ++c) CHECK(!c.is_probable_prime());
+    CHECK_EQ(((BigInt(1) << 89) - 2).next_prime(), (BigInt(1) << 89) - 1);
+
+    ThresholdGuard guard;
+    std::vector<BigInt> v;
+    for (int i=0; i<200; ++i) v.push_back(random_bigint(1 + test_rng()() % 700, true));
+    for (size_t threads : {1, 4}){
+        BigInt::thread_count = threads;
+        std::vector<bool> res = BigInt::are_probable_primes(v, 1);
+        CHECK_EQ(res.size(), v.size());
+        for (size_t i=0; i<v.size(); ++i) CHECK_EQ(res[i], v[i].is_probable_prime());
+    }
+}
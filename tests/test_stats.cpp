@@ -0,0 +1,64 @@
+#include "test.hpp"
+#include <thread>
+#include <vector>
+
+static size_t size_class(size_t limbs){
+    size_t res = 0;
+    for (; limbs; limbs >>= 1) ++res;
+    return res;
+}
+
+TEST(stats, counts_operations){
+    // sizes below every fast tier, so each call is one operation and nothing nests
+    BigInt a = random_bigint(20 * BigInt::limb_bits), b = random_bigint(20 * BigInt::limb_bits);
+    BigInt c = random_bigint(40 * BigInt::limb_bits), r;
+    BigInt::reset_stats();
+    for (int i=0; i<10; ++i) r = a * b;
+    r = c / a;
+    std::string s = c.to_string(16);
+    r.from_cstr(s.c_str(), 16);
+    BigInt::Stats st = BigInt::stats();
+    if (!BigInt::stats_enabled){
+        CHECK_EQ(st[BigInt::Operation::mul].calls, 0u);
+        CHECK_EQ(st.allocations, 0u);
+        return;
+    }
+    const BigInt::OperationStats& mul = st[BigInt::Operation::mul];
+    CHECK_EQ(mul.calls, 10u);
+    CHECK_EQ(mul.sizes[size_class(20)], 10u);
+    CHECK(mul.allocations >= 10);
+    CHECK(mul.bytes_allocated >= 10 * 40 * sizeof(BigInt::limb_t));
+    CHECK_EQ(st[BigInt::Operation::div].calls, 1u);
+    CHECK_EQ(st[BigInt::Operation::div].sizes[size_class(40)], 1u);
+    CHECK_EQ(st[BigInt::Operation::to_string].calls, 1u);
+    CHECK_EQ(st[BigInt::Operation::from_string].calls, 1u);
+    CHECK_EQ(st[BigInt::Operation::from_string].sizes[size_class(40)], 1u);
+    CHECK_EQ(r, c);
+    CHECK(st.allocations >= mul.allocations);
+    CHECK(st.bytes_allocated >= mul.bytes_allocated);
+    CHECK_EQ(std::string(BigInt::Stats::name(BigInt::Operation::prime_test)), "prime_test");
+
+    BigInt::reset_stats();
+    st = BigInt::stats();
+    CHECK_EQ(st[BigInt::Operation::mul].calls, 0u);
+    CHECK_EQ(st.allocations, 0u);
+}
+
+TEST(stats, growth_and_threads){
+    BigInt::reset_stats();
+    BigInt x = 1;
+    for (int i=0; i<100; ++i) x <<= BigInt::limb_bits; // grows one limb at a time
+    if (BigInt::stats_enabled) CHECK(BigInt::stats().reallocations > 0);
+
+    // finished threads still count
+    BigInt a = random_bigint(3000), b = random_bigint(3000);
+    BigInt::reset_stats();
+    std::vector<std::thread> threads;
+    for (int t=0; t<4; ++t)
+        threads.emplace_back([&]{for (int i=0; i<25; ++i) BigInt r = gcd(a * b, b);});
+    for (std::thread& t : threads) t.join();
+    BigInt::Stats st = BigInt::stats();
+    CHECK_EQ(st[BigInt::Operation::gcd].calls, BigInt::stats_enabled ? 100u : 0u);
+    CHECK(st[BigInt::Operation::mul].calls >= (BigInt::stats_enabled ? 100u : 0u));
+    CHECK(st[BigInt::Operation::gcd].nanoseconds >= st[BigInt::Operation::gcd].calls);
+}